@@ -1,47 +1,130 @@
 #include "include/b_plus_tree.hpp"
 #include "include/tabela.hpp"
+#include "include/csv.hpp"
 
-size_t BPlusTree::get_code(const std::string& search_key)
+#include <set>
+#include <map>
+
+bool BPlusTree::find_code(const std::string& search_key, size_t& code, const size_t& part)
+{
+    auto entry = codes[part].find(search_key);
+    if (entry == codes[part].end()) return false;
+    code = entry->second;
+    return true;
+}
+
+size_t BPlusTree::get_code(const std::string& search_key, const size_t& part)
 {
-    std::string code_file_path = codes_directory /*+ "k-"*/ + search_key;
-    std::fstream code_file(code_file_path);
     size_t code;
-    if (!code_file)
-    {
-        code_file.clear();
-        code_file.open(code_file_path, std::ios::in | std::ios::out | std::ios::trunc);
-        code_file << unique_keys << '\n';
-        // std::fstream key_file(codes_directory + std::to_string(unique_keys), std::ios::in | std::ios::out | std::ios::trunc);
-        // key_file << search_key << '\n';
-        code = unique_keys++;
-    } else {
-        code_file >> code;
-    }
-    
+    if (find_code(search_key, code, part)) return code;
+
+    code = unique_codes[part]++;
+    values[part].push_back(search_key);
+    codes[part].emplace(search_key, code);
     return code;
 }
 
-std::string BPlusTree::search_dir(const std::string& search_key) { return table.result_directory + this->search_key + "=" + search_key + "/"; };
+SearchKey BPlusTree::get_search_key(const Tuple& tuple)
+{
+    SearchKey key{};
+    for (size_t i = 0; i < columns.size(); i++) key[i] = get_code(tuple[columns[i]], i);
+    return key;
+}
 
-TablePageSystem BPlusTree::newResultPage(const std::string& search_key)
+size_t BPlusTree::count_unique_keys()
 {
-    return PageSystem(search_dir(search_key), table.newTuple);
+    auto cur = cursor();
+    size_t count = 0;
+    bool first = true;
+    SearchKey last;
+
+    for (cur->rewind(); cur->valid(); cur->next())
+    {
+        if (first || cur->key().search_key != last)
+        {
+            count++;
+            last = cur->key().search_key;
+            first = false;
+        }
+    }
+
+    return count;
 }
 
-BPlusTree::BPlusTree(const Tabela& table, const std::string& search_key):
+bool BPlusTree::direct_io() const { return table.direct_io; }
+
+std::string BPlusTree::search_dir(const std::string& search_key) { return table.result_directory + columns[0] + "=" + search_key + "/"; };
+
+BPlusTree::BPlusTree(const Tabela& table, const std::vector<std::string>& columns):
+    node_fd(-1),
     table(table),
-    directory(table.directory + "trees/" + search_key + "/"),
-    codes_directory(directory + "codes/"),
-    search_key(search_key),
-    root(HEADER_WIDTH+1),
+    search_key(csv(columns)),
+    directory(table.directory + "trees/" + csv(columns) + "/"),
+    columns(columns),
+    unique_codes(columns.size(), 0),
+    values(columns.size()),
+    codes(columns.size()),
     depth(0),
     unique_keys(0)
 {
-    std::filesystem::create_directories(codes_directory);
-    indices.open(directory + "tree", std::ios_base::in | std::ios_base::out | std::ios_base::trunc);
+    if (columns.empty() || columns.size() > MAX_KEY_PARTS)
+        throw std::invalid_argument("um índice deve ter de 1 a " + std::to_string(MAX_KEY_PARTS) + " colunas: " + csv(columns));
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+        if (std::find(table.scheme.begin(), table.scheme.end(), columns[i]) == table.scheme.end())
+            throw std::invalid_argument("coluna inexistente em " + table.name + ": " + columns[i]);
+        if (std::find(columns.begin(), columns.begin() + i, columns[i]) != columns.begin() + i)
+            throw std::invalid_argument("coluna repetida no índice: " + columns[i]);
+    }
+
+    std::filesystem::create_directories(directory);
+    PageCache::shared().invalidate(directory + "tree");    // nós de um índice anterior no mesmo diretório
+    indices.open(directory + "tree", std::ios_base::in | std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+}
+
+void BPlusTree::build()
+{
+    assign_codes();
+    insert_all();
+
+    // A partir daqui os nós só são lidos: as leituras passam a ser feitas com pread, sem o buffer
+    // (nem as reposições de cursor) do fluxo, e podem ser feitas por várias threads simultaneamente.
+    // No modo de E/S direta da tabela, o arquivo é aberto com O_DIRECT e os nós lidos passam pelo PageCache.
+    indices.clear();
+    indices.flush();
+    auto path = directory + "tree";
+    node_fd = table.direct_io? open_direct(path, O_RDONLY): open(path.c_str(), O_RDONLY);
+
+    unique_keys = count_unique_keys();
+}
+
+const std::vector<size_t>& BPlusTree::supported_fanouts()
+{
+    static const std::vector<size_t> fanouts {MAX_CHILDREN, 16, 64, 256, 512};
+    return fanouts;
+}
+
+std::shared_ptr<BPlusTree> BPlusTree::create(const Tabela& table, const std::vector<std::string>& columns, const size_t& fanout)
+{
+    switch (fanout)
+    {
+        case MAX_CHILDREN: return std::make_shared<BasicBPlusTree<MAX_CHILDREN>>(table, columns);
+        case 16: return std::make_shared<BasicBPlusTree<16>>(table, columns);
+        case 64: return std::make_shared<BasicBPlusTree<64>>(table, columns);
+        case 256: return std::make_shared<BasicBPlusTree<256>>(table, columns);
+        case 512: return std::make_shared<BasicBPlusTree<512>>(table, columns);
+        default: throw std::invalid_argument("fanout não suportado: " + std::to_string(fanout));
+    }
+}
+
+template <size_t F>
+BasicBPlusTree<F>::BasicBPlusTree(const Tabela& table, const std::vector<std::string>& columns):
+    BPlusTree(table, columns),
+    root(HEADER_WIDTH+1)
+{
     update_header();    // escreve cabeçalho
     indices << root;    // escreve raiz
-    insert_all();
+    build();
 }
 
 // BPlusTree::BPlusTree(BPlusTree&& tree):
@@ -53,7 +136,8 @@ BPlusTree::BPlusTree(const Tabela& table, const std::string& search_key):
 //     root(std::move(root))
 // { }
 
-void BPlusTree::update_header()
+template <size_t F>
+void BasicBPlusTree<F>::update_header()
 {
     std::stringstream header;
     header << root.pos << ' ' << depth;
@@ -61,6 +145,20 @@ void BPlusTree::update_header()
     indices << std::left << std::setw(HEADER_WIDTH) << std::setfill(' ') << header.str() << '\n';
 }
 
+void BPlusTree::assign_codes()
+{
+    std::vector<std::set<std::string, ValueLess>> distinct(columns.size());
+    for (auto iter = table.get_tuple_iterator(); !iter.reached_end(); iter++)
+    {
+        for (size_t i = 0; i < columns.size(); i++) distinct[i].insert(iter[columns[i]]);
+    }
+
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+        for (const auto& value: distinct[i]) get_code(value, i);
+    }
+}
+
 void BPlusTree::insert_all()
 {
 
@@ -69,13 +167,31 @@ void BPlusTree::insert_all()
 
     // percorremos o arquivo de dados, linha a linha, a partir do primeiro registro
     // inserindo na árvore uma chave única para cada registro
+    // as tuplas de cada página são agregadas por chave de busca antes da inserção,
+    // de modo que cada chave seja inserida uma única vez por página, já com sua contagem de tuplas.
+    std::map<SearchKey, size_t> page_counts;
+    size_t page = 0;
+
+    auto flush = [&]()
+    {
+        for (const auto& [search_key, count]: page_counts) insert(Key(search_key, page, count));
+        page_counts.clear();
+    };
+
     for (auto iter = table.get_tuple_iterator(); !iter.reached_end(); iter++)
     {
-        insert(Key(get_code(iter[search_key]), iter.cur_page_index));
+        if (iter.cur_page_index != page)
+        {
+            flush();
+            page = iter.cur_page_index;
+        }
+        page_counts[get_search_key(*iter)]++;
     }
+    flush();
 }
 
-bool BPlusTree::insert(const Key&k, const size_t& add)
+template <size_t F>
+bool BasicBPlusTree<F>::insert(const Key&k, const size_t& add)
 {
     set_leaf(k);    // faz com que o nó auxiliar buffer[0] seja o nó correto para a inserção de k
                     // a propriedades da árvore B+ garantem que esse nó correto seja único
@@ -91,7 +207,10 @@ bool BPlusTree::insert(const Key&k, const size_t& add)
         if (overflow_node.m == 0)
         {
             // esse é o caso em que a chave já está na folha
-            // não fazemos nada
+            // apenas sua contagem de tuplas foi atualizada, então regravamos a folha
+            indices.seekp(cur_node.pos);
+            indices << cur_node;
+            if (cur_node.pos == root.pos) root = cur_node;
             return false;
         }
 
@@ -122,9 +241,10 @@ bool BPlusTree::insert(const Key&k, const size_t& add)
             indices << right;           // a fim de sobrescrever e atualizar a linha correspondente no arquivo de índices
         }
 
-        bool inserted;  // indica se o último nó de overflow criado foi inserido na árvore
-                        // isso só é falso quando particionamos a raiz, visto que ela não possui pai
-                        // e, portanto, para inserir o nó de overflow, devemos criar uma nova raiz
+        bool inserted = false;  // indica se o último nó de overflow criado foi inserido na árvore
+                                // isso só é falso quando particionamos a raiz, visto que ela não possui pai
+                                // e, portanto, para inserir o nó de overflow, devemos criar uma nova raiz
+                                // (inclusive quando a folha partida é a própria raiz, caso em que o laço abaixo não é executado)
         Key min = overflow_node.min();  // tomamos como divisor de intervalo a menor chave do nó de overflow
                                         // pois devemos garantir que os nós à esquerda sejam estritamente menores
                                         // e os sucessores maiores ou iguais
@@ -150,7 +270,7 @@ bool BPlusTree::insert(const Key&k, const size_t& add)
                 indices.append();   // vamos ao fim do arquivo
                 cur_node = overflow_node;   // tomamos como nó atual o nó de overflow
                 cur_node.pos = indices.tellp(); //
-                overflow_node.pos = cur_node.pos + LINE_WIDTH + 1;
+                overflow_node.pos = cur_node.pos + sizeof(Node);
 
                 inserted = parent_node.insert(min, cur_node.pos, overflow_node);
 
@@ -200,7 +320,7 @@ bool BPlusTree::insert(const Key&k, const size_t& add)
             auto& right = overflow_node;
             auto& new_root = root;
 
-            new_root.pos = right.pos + (LINE_WIDTH + 1);
+            new_root.pos = right.pos + sizeof(Node);
             left.parent = right.parent = new_root.pos;
 
             depth++;
@@ -210,6 +330,7 @@ bool BPlusTree::insert(const Key&k, const size_t& add)
             new_root.m = 1;
             new_root.keys[0] = min;
             new_root.ptrs[0] = left.pos; new_root.ptrs[1] = right.pos;
+            new_root.sync_lanes();
 
             // indices.flush();
             indices.seekp(right.pos);
@@ -251,83 +372,101 @@ TupleIterator BPlusTree::operator [] (const std::string& search_key) { return ge
 
 size_t BPlusTree::select(const std::string& search_key)
 {
-    size_t code = get_code(search_key);
-    set_leaf_weak(code);
-    auto& cur_node = buffer[0];
-    size_t p, count = 0;
-    if (((LN) cur_node).get_pos_weak(code, p))
+    const std::string keys[1] = {columns[0]}, values[1] = {search_key};
+    return select(keys, values).tuples;
+}
+
+Generator<Tuple> BPlusTree::stream(std::vector<std::string> keys, std::vector<std::string> values, Stats& stats)
+{
+    auto code = get_prefix(keys, values);
+    stats.ios++;
+    auto cur = cursor();
+    size_t synced = 0;
+    // Repassa a stats os nós lidos pelo cursor desde a última sincronização.
+    auto sync = [&]()
     {
-        PageSystem result_page = newResultPage(search_key);
-        PageSystem table_page = table.get_page();
-        while (true)
+        stats.ios += cur->ios - synced;
+        synced = cur->ios;
+    };
+
+    TablePageSystem table_page = table.get_page();
+    std::unordered_set<size_t> seen;    // páginas já visitadas sob outras chaves do prefixo
+    for (cur->seek(code); cur->valid() && Key::weak_comparator(cur->key(), code) == 0; cur->next())
+    {
+        sync();
+        size_t page = cur->key().page;
+        if (!seen.insert(page).second) continue;
+        if (!table.may_match(page, keys, values))
         {
-            if (p < cur_node.m)
-            {
-                if (cur_node.keys[p].search_key != code) break;
-                table_page.load_page(cur_node.keys[p].page);
-                table_page.load_tuples();
-    
-                for (size_t i = 0; i < table_page.buffer_page.occupancy; i++)
-                {
-                    const auto& cur_tuple = table_page[i]; 
-                    if (cur_tuple[this->search_key] == search_key)
-                        result_page << cur_tuple;
-                }
-                count++;
-                p++;
-                continue;
-            }
-            
-            if (cur_node.r == 0) break;
-            set_node(cur_node.r, cur_node);
-            p = 0;
+            stats.skipped++;
+            continue;
+        }
+        table_page.load_page(page);
+        stats.ios++;
+        table_page.load_tuples();
+        for (size_t i = 0; i < table_page.buffer_page.occupancy; i++)
+        {
+            const Tuple& tuple = table_page[i];
+            bool match = true;
+            for (size_t j = 0; j < keys.size() && match; j++) match = tuple[keys[j]] == values[j];
+            if (match) co_yield tuple;
         }
-        result_page.update_header();
-        result_page.save_page();
     }
-
-    return count;
+    sync();
 }
 
-size_t BPlusTree::set_leaf(const Key& k, size_t node_id)
+size_t BPlusTree::count(const KeyPrefix& prefix, Stats& stats)
 {
-    auto& cur_node = buffer[node_id];
-    cur_node = root;
-
-    while (!cur_node.leaf)
+    auto cur = cursor();
+    size_t total = 0;
+    for (cur->seek(prefix); cur->valid() && Key::weak_comparator(cur->key(), prefix) == 0; cur->next())
     {
-        set_node(((IN) cur_node).get_ptr(k), cur_node);
+        total += cur->key().count;
     }
-
-    return cur_node.pos;
+    stats.ios += cur->ios;
+    return total;
 }
 
-std::array<size_t, 2> BPlusTree::set_leaf_weak(const size_t& code, const size_t& node_id)
+template <size_t F>
+size_t BasicBPlusTree<F>::set_leaf(const Key& k, size_t node_id)
 {
     auto& cur_node = buffer[node_id];
-    cur_node = root;
-    
-    size_t ios = 0;
-
-    while (!cur_node.leaf)
+    if (root.leaf)
     {
-        set_node(((IN) cur_node).get_ptr_weak(code), cur_node);
-        ios++;
+        cur_node = root;
+        return cur_node.pos;
     }
 
-    while (cur_node.r != 0 && (cur_node.m == 0 || cur_node.max().search_key < code))
+    set_node(root.get_ptr(k), cur_node);
+    while (!cur_node.leaf)
     {
-        set_node(cur_node.r, cur_node);
-        ios++;
+        set_node(cur_node.get_ptr(k), cur_node);
     }
 
-    return {cur_node.pos, ios};
+    return cur_node.pos;
 }
 
-void BPlusTree::set_node(const size_t& pos, Node& out)
+template <size_t F>
+bool BasicBPlusTree<F>::set_node(const size_t pos, Node& out)
 {
+    auto bytes = reinterpret_cast<char*>(&out);
+    bool hit = false;
+    if (node_fd < 0) indices.read_at(pos, bytes, sizeof(Node));
+    else if (!direct_io()) AsyncIO::read(node_fd, pos, bytes, sizeof(Node));
+    else
+    {
+        auto path = directory + "tree";
+        hit = PageCache::shared().get(path, pos, bytes, sizeof(Node));
+        if (!hit && read_direct(node_fd, pos, bytes, sizeof(Node)) == (long) sizeof(Node))
+            PageCache::shared().put(path, pos, bytes, sizeof(Node));
+    }
+    if (!hit) Instrumentation::read(sizeof(Node));
     out.pos = pos;
-    std::string line;
-    indices.getline(pos, line);
-    out << line;
-}
\ No newline at end of file
+    return hit;
+}
+
+template class BasicBPlusTree<MAX_CHILDREN>;
+template class BasicBPlusTree<16>;
+template class BasicBPlusTree<64>;
+template class BasicBPlusTree<256>;
+template class BasicBPlusTree<512>;
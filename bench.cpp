@@ -0,0 +1,240 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include "include/tabela.hpp"
+#include "include/operador.hpp"
+#include "include/selecao_lote.hpp"
+#include "include/varredura.hpp"
+#include "include/gerador.hpp"
+
+// Benchmark dos caminhos de carga e de consulta.
+// Uso: ./bench [QUANTIDADES_DE_TUPLAS...] [--queries Q] [--skew S] [--fanout F] [--page-capacity C] [--direct] [--threads T]
+// Para cada quantidade (por padrão 1000, 10000 e 100000), gera uma tabela sintética com o esquema de vinho.csv
+// (chaves estrangeiras com assimetria de Zipf S, por padrão 0, isto é, uniformes; índices com fanout F
+// e páginas de C tuplas, por padrão MAX_CHILDREN e PAGE_SIZE; com --direct, em modo de E/S direta) e mede carga do csv,
+// construção de índice por coluna, seleção pontual (uma a uma e em lote), seleção com dois predicados, exportação do resultado,
+// seleção de valores frequentes e varredura completa, ambas com uma thread e com as T threads do escalonador
+// (por padrão, uma por núcleo), e as métricas do escalonador. Cada medição é impressa como um objeto JSON por linha
+// na saída padrão.
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+static double seconds_since(const Clock::time_point& start)
+{
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Percentil (0 a 100) de uma amostra já ordenada.
+static double percentile(const vector<double>& sorted, const double& p)
+{
+    if (sorted.empty()) return 0;
+    size_t i = min(sorted.size() - 1, (size_t) (p / 100 * sorted.size()));
+    return sorted[i];
+}
+
+// Gera a tabela vinho com <num_tuples> tuplas e chaves estrangeiras com assimetria <skew> (ver WineDataset).
+static string generate_csv(const size_t& num_tuples, const double& skew)
+{
+    string dir = string(GEN_DIR) + "bench/";
+    filesystem::create_directories(dir);
+    string path = dir + "vinho_" + to_string(num_tuples) + ".csv";
+
+    WineDataset dataset;
+    dataset.vinhos = num_tuples;
+    dataset.skew = skew;
+    ofstream csv(path, ios::trunc);
+    generate_table(csv, {"vinho_id", "rotulo", "ano_producao", "uva_id", "pais_producao_id"}, dataset.vinho(), num_tuples, num_tuples);
+    return path;
+}
+
+static void report_throughput(const string& bench, const size_t& num_tuples, const double& elapsed, const string& extra = "")
+{
+    cout << "{\"bench\":\"" << bench << "\",\"tuples\":" << num_tuples << ",\"seconds\":" << elapsed
+         << ",\"tuples_per_second\":" << (elapsed > 0? num_tuples / elapsed: 0) << extra << "}" << endl;
+}
+
+// Executa as consultas especificadas e reporta latências e médias das estatísticas de I/O.
+template <size_t N>
+static void bench_select(const string& bench, Tabela& table, const size_t& num_tuples,
+    const string (&keys)[N], const vector<array<string, N>>& queries, const bool& export_results, const size_t& threads = 1)
+{
+    vector<double> latencies, export_latencies;
+    size_t pags = 0, ios = 0, tuples = 0, skipped = 0, bytes_read = 0, node_misses = 0, page_hits = 0;
+
+    for (const auto& query: queries)
+    {
+        string values[N];
+        copy(query.begin(), query.end(), values);
+
+        auto start = Clock::now();
+        Operador op {table, keys, values, threads};
+        op.executar();
+        latencies.push_back(seconds_since(start) * 1000);
+
+        pags += op.numPagsGeradas();
+        ios += op.numIOExecutados();
+        tuples += op.numTuplasGeradas();
+        skipped += op.numPagsEvitadas();
+        bytes_read += op.instrumentacao().bytes_read;
+        node_misses += op.instrumentacao().node_misses;
+        page_hits += op.instrumentacao().page_hits;
+
+        if (export_results)
+        {
+            start = Clock::now();
+            op.salvarTuplasGeradas(string(GEN_DIR) + "bench/export.csv");
+            export_latencies.push_back(seconds_since(start) * 1000);
+        }
+    }
+
+    auto report = [&](const string& name, vector<double>& samples)
+    {
+        sort(samples.begin(), samples.end());
+        double total = 0;
+        for (const auto& sample: samples) total += sample;
+        double q = samples.size();
+        cout << "{\"bench\":\"" << name << "\",\"tuples\":" << num_tuples << ",\"queries\":" << samples.size() << ",\"threads\":" << threads
+             << ",\"queries_per_second\":" << (total > 0? q / (total / 1000): 0)
+             << ",\"p50_ms\":" << percentile(samples, 50) << ",\"p95_ms\":" << percentile(samples, 95)
+             << ",\"p99_ms\":" << percentile(samples, 99) << ",\"max_ms\":" << (samples.empty()? 0: samples.back())
+             << ",\"avg_pags\":" << pags / q << ",\"avg_ios\":" << ios / q << ",\"avg_tuples\":" << tuples / q
+             << ",\"avg_skipped\":" << skipped / q << ",\"avg_bytes_read\":" << bytes_read / q
+             << ",\"avg_node_misses\":" << node_misses / q << ",\"avg_page_hits\":" << page_hits / q << "}" << endl;
+    };
+
+    report(bench, latencies);
+    if (export_results) report(bench + "_export", export_latencies);
+}
+
+// Executa as consultas especificadas num único lote (ver SelecaoEmLote) e reporta a vazão e os I/Os por consulta.
+template <size_t N>
+static void bench_batch(const string& bench, Tabela& table, const size_t& num_tuples,
+    const string (&keys)[N], const vector<array<string, N>>& queries)
+{
+    SelecaoEmLote<N> batch {table, keys};
+    for (const auto& query: queries) batch.adicionar(query);
+
+    auto start = Clock::now();
+    batch.executar();
+    double elapsed = seconds_since(start);
+
+    double q = queries.size();
+    cout << "{\"bench\":\"" << bench << "\",\"tuples\":" << num_tuples << ",\"queries\":" << queries.size()
+         << ",\"seconds\":" << elapsed << ",\"queries_per_second\":" << (elapsed > 0? q / elapsed: 0)
+         << ",\"avg_ios\":" << batch.numIOExecutados() / q << ",\"avg_bytes_read\":" << batch.instrumentacao().bytes_read / q
+         << ",\"avg_node_misses\":" << batch.instrumentacao().node_misses / q << "}" << endl;
+}
+
+// Varredura completa com predicado de intervalo pouco seletivo, executada com <threads> threads.
+static void bench_scan(Tabela& table, const size_t& num_tuples, const size_t& threads)
+{
+    Varredura scan {table, {{"ano_producao", string("1900"), string("2000")}}, threads};
+    auto start = Clock::now();
+    scan.executar();
+    report_throughput("scan", num_tuples, seconds_since(start),
+        ",\"threads\":" + to_string(threads) + ",\"matches\":" + to_string(scan.numTuplasGeradas()));
+}
+
+// Seleções frequentes com LIMIT <n>, consumindo a seleção sob demanda (ver Operador::tuplas) até a <n>-ésima tupla,
+// e reporta latências e I/Os médios, a comparar com os de heavy_select, que lê todas as páginas apontadas.
+template <size_t N>
+static void bench_limit(Tabela& table, const size_t& num_tuples,
+    const string (&keys)[N], const vector<array<string, N>>& queries, const size_t& n)
+{
+    vector<double> latencies;
+    size_t ios = 0, tuples = 0;
+    for (const auto& query: queries)
+    {
+        string values[N];
+        copy(query.begin(), query.end(), values);
+
+        auto start = Clock::now();
+        Operador op {table, keys, values};
+        for (const auto& tuple: limit(op.tuplas(), n)) (void) tuple;
+        latencies.push_back(seconds_since(start) * 1000);
+        ios += op.numIOExecutados();
+        tuples += op.numTuplasGeradas();
+    }
+
+    sort(latencies.begin(), latencies.end());
+    double q = queries.size();
+    cout << "{\"bench\":\"limit_select\",\"tuples\":" << num_tuples << ",\"queries\":" << queries.size() << ",\"limit\":" << n
+         << ",\"p50_ms\":" << percentile(latencies, 50) << ",\"max_ms\":" << (latencies.empty()? 0: latencies.back())
+         << ",\"avg_ios\":" << ios / q << ",\"avg_tuples\":" << tuples / q << "}" << endl;
+}
+
+int main(int argc, char** argv)
+{
+    vector<size_t> sizes;
+    size_t num_queries = 100;
+    double skew = 0;
+    size_t fanout = MAX_CHILDREN, page_capacity = PAGE_SIZE;
+    bool direct_io = false;
+    size_t threads = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--queries" && i + 1 < argc) num_queries = stoul(argv[++i]);
+        else if (arg == "--skew" && i + 1 < argc) skew = stod(argv[++i]);
+        else if (arg == "--fanout" && i + 1 < argc) fanout = stoul(argv[++i]);
+        else if (arg == "--page-capacity" && i + 1 < argc) page_capacity = stoul(argv[++i]);
+        else if (arg == "--direct") direct_io = true;
+        else if (arg == "--threads" && i + 1 < argc) threads = stoul(argv[++i]);
+        else sizes.push_back(stoul(arg));
+    }
+    if (sizes.empty()) sizes = {1000, 10000, 100000};
+    if (threads) Scheduler::configure(threads);
+    auto& scheduler = Scheduler::shared();
+
+    filesystem::remove_all(GEN_DIR);
+
+    for (const auto& num_tuples: sizes)
+    {
+        string path = generate_csv(num_tuples, skew);
+        scheduler.reset_metrics();
+
+        auto start = Clock::now();
+        Tabela table {path, fanout, page_capacity, direct_io};
+        table.carregarDados(vector<string>{});
+        report_throughput("ingest", num_tuples, seconds_since(start),
+            ",\"fanout\":" + to_string(fanout) + ",\"page_capacity\":" + to_string(page_capacity) +
+            ",\"direct_io\":" + (direct_io? "true": "false"));
+
+        for (const auto& column: {"ano_producao", "uva_id", "pais_producao_id", "rotulo"})
+        {
+            start = Clock::now();
+            table.criarIndice({column});
+            report_throughput("index_build", num_tuples, seconds_since(start), string(",\"column\":\"") + column + "\"");
+        }
+
+        mt19937_64 rng(42);
+        vector<array<string, 1>> point_queries;
+        vector<array<string, 2>> multi_queries;
+        vector<array<string, 1>> heavy_queries {{"0"}, {"1"}, {"2"}, {"3"}, {"4"}};   // ~1/5 da tabela cada
+        for (size_t i = 0; i < num_queries; i++)
+        {
+            point_queries.push_back({to_string(1900 + rng() % 121)});
+            multi_queries.push_back({to_string(1900 + rng() % 121), to_string(rng() % 5)});
+        }
+
+        bench_select("point_select", table, num_tuples, {"ano_producao"}, point_queries, false);
+        bench_batch("batch_select", table, num_tuples, {"ano_producao"}, point_queries);
+        bench_select("multi_select", table, num_tuples, {"ano_producao", "pais_producao_id"}, multi_queries, true);
+        bench_select("heavy_select", table, num_tuples, {"pais_producao_id"}, heavy_queries, false);
+        bench_select("heavy_select", table, num_tuples, {"pais_producao_id"}, heavy_queries, false, scheduler.size());
+        bench_limit(table, num_tuples, {"pais_producao_id"}, heavy_queries, 10);
+        bench_scan(table, num_tuples, 1);
+        bench_scan(table, num_tuples, scheduler.size());
+        cout << "{\"bench\":\"scheduler\",\"tuples\":" << num_tuples << ",\"metrics\":" << scheduler.json() << "}" << endl;
+
+        filesystem::remove_all(string(GEN_DIR) + "vinho_" + to_string(num_tuples));
+    }
+
+    return 0;
+}
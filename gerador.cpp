@@ -0,0 +1,92 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "include/gerador.hpp"
+
+// Gerador de tabelas sintéticas.
+//
+// Uso 1 (vinho, uva e pais com chaves estrangeiras consistentes):
+//   ./gerador --vinhos N [--uvas U] [--paises P] [--skew S] [--correlacao C] [--seed X] [--saida DIR]
+//   Grava DIR/pais.csv, DIR/uva.csv e DIR/vinho.csv (por padrão, DIR = generated/dados/).
+//
+// Uso 2 (cabeçalho arbitrário):
+//   ./gerador --cabecalho a,b,c --linhas N [--coluna a=ESPEC]... [--seed X] [--saida ARQUIVO]
+//   Sem --saida, o csv é escrito na saída padrão. Ver ColumnGenerator para o formato de ESPEC.
+
+using namespace std;
+
+static vector<string> split(const string& str, const char& sep)
+{
+    vector<string> parts;
+    stringstream ss(str);
+    string part;
+    while (getline(ss, part, sep)) parts.push_back(part);
+    return parts;
+}
+
+int main(int argc, char** argv)
+{
+    WineDataset dataset;
+    bool wine = false;
+    vector<string> header;
+    map<string, string> specs;
+    size_t rows = 0, seed = 42;
+    string output;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (i + 1 >= argc) throw invalid_argument("valor ausente para " + arg);
+            string value = argv[++i];
+
+            if (arg == "--vinhos") { dataset.vinhos = stoul(value); wine = true; }
+            else if (arg == "--uvas") dataset.uvas = stoul(value);
+            else if (arg == "--paises") dataset.paises = stoul(value);
+            else if (arg == "--skew") dataset.skew = stod(value);
+            else if (arg == "--correlacao") dataset.correlation = stod(value);
+            else if (arg == "--cabecalho") header = split(value, ',');
+            else if (arg == "--linhas") rows = stoul(value);
+            else if (arg == "--coluna")
+            {
+                auto eq = value.find('=');
+                if (eq == string::npos) throw invalid_argument("esperado NOME=ESPEC: " + value);
+                specs[value.substr(0, eq)] = value.substr(eq + 1);
+            }
+            else if (arg == "--seed") seed = stoul(value);
+            else if (arg == "--saida") output = value;
+            else throw invalid_argument("opção desconhecida: " + arg);
+        }
+
+        if (wine)
+        {
+            string dir = output.empty()? string("generated/dados/"): output + "/";
+            filesystem::create_directories(dir);
+            ofstream pais(dir + "pais.csv"), uva(dir + "uva.csv"), vinho(dir + "vinho.csv");
+            generate_table(pais, {"pais_id", "nome", "sigla"}, dataset.pais(), dataset.paises, seed);
+            generate_table(uva, {"uva_id", "nome", "tipo", "ano_colheita", "pais_origem_id"}, dataset.uva(), dataset.uvas, seed + 1);
+            generate_table(vinho, {"vinho_id", "rotulo", "ano_producao", "uva_id", "pais_producao_id"}, dataset.vinho(), dataset.vinhos, seed + 2);
+        }
+        else if (!header.empty())
+        {
+            if (output.empty()) generate_table(cout, header, specs, rows, seed);
+            else
+            {
+                ofstream out(output);
+                generate_table(out, header, specs, rows, seed);
+            }
+        }
+        else throw invalid_argument("especifique --vinhos ou --cabecalho");
+    }
+    catch (const exception& e)
+    {
+        cerr << "gerador: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+#ifndef AGREGACAO_HPP
+#define AGREGACAO_HPP
+
+#include <map>
+#include <unordered_set>
+#include <algorithm>
+#include <stdexcept>
+
+#include "b_plus_tree.hpp"
+#include "csv.hpp"
+#include "stats.hpp"
+
+// Contagem: SELECT COUNT(*) FROM tabela WHERE col_1 = con_1 AND ... AND col_n = con_n
+// Quando algum índice tem como prefixo exatamente as colunas dos predicados, a contagem é obtida
+// somando as contagens de tuplas armazenadas nas folhas, sem acessar páginas de dados.
+// Caso contrário, as páginas apontadas pelo índice mais seletivo são carregadas e suas tuplas verificadas.
+// Sem predicados, a contagem é obtida da quantidade de páginas e da ocupação da última.
+class Contagem
+{
+private:
+    Tabela& table;
+    const std::vector<std::string> keys, values;
+    size_t total;
+    Stats stats;
+
+    std::string result_directory()
+    {
+        std::stringstream ss;
+        ss << table.result_directory << "count:";
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            if (i != 0) ss << ",";
+            ss << keys[i] << "=" << values[i];
+        }
+        ss << "/";
+        return ss.str();
+    }
+
+    bool matches_restriction(const Tuple& tuple)
+    {
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            if (tuple[keys[i]] != values[i]) return false;
+        }
+        return true;
+    }
+
+    // Percorre as páginas apontadas pelo prefixo da árvore, contando as tuplas que satisfazem todos os predicados.
+    // Uma página apontada por várias chaves do prefixo (índices compostos) é lida e contada uma única vez.
+    size_t count_pages(BPlusTree& tree)
+    {
+        auto prefix = tree.get_prefix(keys, values);
+        auto cursor = tree.cursor();
+        size_t count = 0;
+        std::unordered_set<size_t> seen;
+
+        TablePageSystem table_page = table.get_page();
+        for (cursor->seek(prefix); cursor->valid(); cursor->next())
+        {
+            const Key& key = cursor->key();
+            if (Key::weak_comparator(key, prefix) != 0) break;
+            if (!seen.insert(key.page).second) continue;
+            if (!table.may_match(key.page, keys, values))
+            {
+                stats.skipped++;
+                continue;
+            }
+            table_page.load_page(key.page);
+            stats.ios++;
+            table_page.load_tuples();
+            for (size_t i = 0; i < table_page.buffer_page.occupancy; i++)
+            {
+                if (matches_restriction(table_page[i])) count++;
+            }
+        }
+        stats.ios += cursor->ios;
+
+        return count;
+    }
+
+public:
+    Contagem(Tabela& table): table(table), total(0), stats(0, 0, 0) {}
+
+    template <size_t N>
+    Contagem(Tabela& table, const std::string (&keys)[N], const std::string (&values)[N])
+        : table(table), keys(keys, keys + N), values(values, values + N), total(0), stats(0, 0, 0)
+    {}
+
+    void executar()
+    {
+        stats = Stats(0, 0, 0);
+
+        if (keys.empty())
+        {
+            TablePageSystem table_page = table.get_page();
+            table_page.append();
+            stats.ios++;
+            total = (table_page.occupancy - 1)*table_page.capacity() + table_page.buffer_page.occupancy;
+        }
+        else
+        {
+            // índice coberto: as colunas dos predicados formam exatamente um prefixo de suas colunas
+            std::shared_ptr<BPlusTree> covering, best;
+            size_t best_distinct = 0;
+            for (const auto& [name, tree]: table.indices)
+            {
+                size_t n = tree->prefix_length(keys);
+                if (n == keys.size() && (!covering || tree->columns.size() < covering->columns.size())) covering = tree;
+
+                size_t cur_distinct = tree->estimated_distinct(n);
+                if (cur_distinct > best_distinct)
+                {
+                    best = tree;
+                    best_distinct = cur_distinct;
+                }
+            }
+
+            if (covering) total = covering->count(covering->get_prefix(keys, values), stats);
+            else if (best) total = count_pages(*best);
+            else
+            {
+                for (auto iter = table.get_tuple_iterator(); !iter.reached_end(); iter++)
+                {
+                    if (matches_restriction(*iter)) total++;
+                }
+                stats.ios += table.get_page().occupancy;
+            }
+        }
+
+        std::filesystem::remove_all(result_directory());
+        TablePageSystem result_page(result_directory(), table.newTuple);
+        result_page << std::to_string(total);
+        result_page.update_header();
+        result_page.save_page();
+        stats.pags = result_page.occupancy;
+        stats.tuples = 1;
+    }
+
+    inline size_t resultado() { return total; }
+
+    void salvarTuplasGeradas(const std::string& path)
+    {
+        std::fstream out(path, std::ios::in | std::ios::out | std::ios::trunc);
+        out << "count\n";
+        TablePageSystem result_page(result_directory(), table.newTuple);
+        result_page.copy_to(out);
+        stats.ios += result_page.occupancy;
+    }
+
+    inline size_t numPagsGeradas()
+    {
+        return stats.pags;
+    }
+
+    inline size_t numIOExecutados()
+    {
+        return stats.ios;
+    }
+
+    inline size_t numTuplasGeradas()
+    {
+        return stats.tuples;
+    }
+};
+
+// Agrupamento: SELECT col, COUNT(*) FROM tabela GROUP BY col
+// Com um índice cuja primeira coluna seja a de agrupamento, os grupos são obtidos percorrendo as folhas
+// em ordem (e, portanto, em ordem crescente de valor), somando as contagens de tuplas das chaves.
+// Sem índice, as páginas são percorridas decodificando apenas a coluna de agrupamento.
+class Agrupamento
+{
+private:
+    Tabela& table;
+    const std::string column;
+    Stats stats;
+
+    std::string result_directory()
+    {
+        return table.result_directory + "group:" + column + "/";
+    }
+
+public:
+    Agrupamento(Tabela& table, const std::string& column): table(table), column(column), stats(0, 0, 0)
+    {
+        if (std::find(table.scheme.begin(), table.scheme.end(), column) == table.scheme.end())
+            throw std::out_of_range("coluna inexistente: " + column);
+    }
+
+    void executar()
+    {
+        stats = Stats(0, 0, 0);
+        std::filesystem::remove_all(result_directory());
+        TablePageSystem result_page(result_directory(), table.newTuple);
+
+        auto tree = table.find_index(column);
+        if (tree)
+        {
+            auto cursor = tree->cursor();
+            cursor->rewind();
+            while (cursor->valid())
+            {
+                size_t code = cursor->key().search_key[0], count = 0;
+                for (; cursor->valid() && cursor->key().search_key[0] == code; cursor->next()) count += cursor->key().count;
+                result_page << tree->decode(code) + "," + std::to_string(count);
+                stats.tuples++;
+            }
+            stats.ios += cursor->ios;
+        }
+        else
+        {
+            std::map<std::string, size_t, ValueLess> groups;
+            std::vector<size_t> positions {(size_t) (std::find(table.scheme.begin(), table.scheme.end(), column) - table.scheme.begin())};
+            TablePageSystem table_page = table.get_page();
+            for (size_t page = 0; page < table_page.occupancy; page++)
+            {
+                table_page.load_page(page);
+                stats.ios++;
+                table_page.load_tuples(positions);
+                for (size_t i = 0; i < table_page.buffer_page.occupancy; i++) groups[table_page[i][column]]++;
+            }
+
+            for (const auto& [value, count]: groups) result_page << value + "," + std::to_string(count);
+            stats.tuples = groups.size();
+        }
+
+        stats.pags = result_page.occupancy;
+        result_page.update_header();
+        result_page.save_page();
+    }
+
+    void salvarTuplasGeradas(const std::string& path)
+    {
+        std::fstream out(path, std::ios::in | std::ios::out | std::ios::trunc);
+        out << column << ",count\n";
+        TablePageSystem result_page(result_directory(), table.newTuple);
+        result_page.copy_to(out);
+        stats.ios += result_page.occupancy;
+    }
+
+    inline size_t numPagsGeradas()
+    {
+        return stats.pags;
+    }
+
+    inline size_t numIOExecutados()
+    {
+        return stats.ios;
+    }
+
+    inline size_t numTuplasGeradas()
+    {
+        return stats.tuples;
+    }
+};
+
+#endif // AGREGACAO_HPP
@@ -0,0 +1,265 @@
+#ifndef ASYNC_IO_HPP
+#define ASYNC_IO_HPP
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#include "consts.hpp"
+
+#if ASYNC_IO && defined(__linux__) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define ASYNC_IO_URING 1
+#endif
+
+// Leitura a ser submetida ao AsyncIO: <length> bytes do descritor <fd>, a partir de <offset>, em <buffer>.
+// Após a conclusão, <result> contém a quantidade de bytes lidos ou, em caso de erro, -errno.
+struct ReadRequest
+{
+    int fd;
+    size_t offset, length;
+    char* buffer;
+    long result;
+    iovec iov;      // uso interno (IORING_OP_READV)
+    void* tag = nullptr;    // livre para o chamador identificar a leitura ao colhê-la
+};
+
+// Camada de E/S assíncrona para leituras de páginas e nós.
+// Usa io_uring (por chamadas de sistema diretas, sem liburing) mantendo até <depth> leituras em voo;
+// quando o io_uring está indisponível (núcleo antigo, seccomp, ASYNC_IO == 0), recai em pread síncrono,
+// com a mesma interface. As leituras são submetidas com submit() e colhidas, em ordem de conclusão, com complete().
+// Não é thread-safe: cada thread usa sua própria instância (ver local()).
+class AsyncIO
+{
+private:
+    unsigned queue_depth;
+    size_t pending;     // requisições enfileiradas e ainda não entregues ao núcleo
+    size_t flying;      // requisições submetidas e ainda não colhidas
+    std::deque<ReadRequest*> done;  // concluídas e ainda não entregues por complete()
+
+#ifdef ASYNC_IO_URING
+    int ring;
+    void *sq_ptr, *cq_ptr;
+    size_t sq_size, cq_size, sqes_size;
+    io_uring_sqe* sqes;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    io_uring_cqe* cqes;
+
+    static inline unsigned load_acquire(const unsigned* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+    static inline void store_release(unsigned* p, const unsigned& v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+    bool setup()
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring = syscall(__NR_io_uring_setup, queue_depth, &params);
+        if (ring < 0) return false;
+
+        sq_size = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+        cq_size = params.cq_off.cqes + params.cq_entries*sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sq_size = cq_size = std::max(sq_size, cq_size);
+
+        sq_ptr = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+        if (sq_ptr == MAP_FAILED) return teardown();
+        cq_ptr = single? sq_ptr: mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+        if (cq_ptr == MAP_FAILED) return teardown();
+        sqes_size = params.sq_entries*sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe*) mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return teardown();
+
+        auto sq = (char*) sq_ptr, cq = (char*) cq_ptr;
+        sq_head = (unsigned*) (sq + params.sq_off.head);
+        sq_tail = (unsigned*) (sq + params.sq_off.tail);
+        sq_mask = (unsigned*) (sq + params.sq_off.ring_mask);
+        sq_array = (unsigned*) (sq + params.sq_off.array);
+        cq_head = (unsigned*) (cq + params.cq_off.head);
+        cq_tail = (unsigned*) (cq + params.cq_off.tail);
+        cq_mask = (unsigned*) (cq + params.cq_off.ring_mask);
+        cqes = (io_uring_cqe*) (cq + params.cq_off.cqes);
+        queue_depth = params.sq_entries;
+        return true;
+    }
+
+    // Desfaz uma configuração parcial; retorna falso para que o chamador recaia no modo síncrono.
+    bool teardown()
+    {
+        if (sqes && sqes != MAP_FAILED) munmap(sqes, sqes_size);
+        if (cq_ptr && cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_size);
+        if (sq_ptr && sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_size);
+        if (ring >= 0) close(ring);
+        ring = -1;
+        sq_ptr = cq_ptr = nullptr;
+        sqes = nullptr;
+        return false;
+    }
+
+    // Entrega ao núcleo as requisições enfileiradas, aguardando ao menos <wait> conclusões.
+    void enter(const unsigned& wait)
+    {
+        while (true)
+        {
+            long r = syscall(__NR_io_uring_enter, ring, (unsigned) pending, wait, wait? IORING_ENTER_GETEVENTS: 0, nullptr, 0);
+            if (r >= 0)
+            {
+                pending -= r;
+                return;
+            }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) return;
+        }
+    }
+#endif
+
+    // Completa sincronamente o restante de uma leitura curta (ou toda ela, no modo de contingência).
+    static void finish(ReadRequest* req)
+    {
+        size_t done = req->result > 0? req->result: 0;
+        if (req->result < 0 && req->result != -EAGAIN && req->result != -EINTR) return;
+        while (done < req->length)
+        {
+            ssize_t r = pread(req->fd, req->buffer + done, req->length - done, req->offset + done);
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0)
+            {
+                req->result = -errno;
+                return;
+            }
+            if (r == 0) break;
+            done += r;
+        }
+        req->result = done;
+    }
+
+public:
+    explicit AsyncIO(const unsigned& depth = IO_QUEUE_DEPTH): queue_depth(depth? depth: 1), pending(0), flying(0)
+    {
+#ifdef ASYNC_IO_URING
+        ring = -1;
+        sq_ptr = cq_ptr = nullptr;
+        sqes = nullptr;
+        setup();
+#endif
+    }
+
+    AsyncIO(const AsyncIO&) = delete;
+    AsyncIO& operator = (const AsyncIO&) = delete;
+
+    ~AsyncIO()
+    {
+        while (flying > 0) complete();
+#ifdef ASYNC_IO_URING
+        teardown();
+#endif
+    }
+
+    // Instância da thread corrente, criada no primeiro uso.
+    static AsyncIO& local()
+    {
+        static thread_local AsyncIO io;
+        return io;
+    }
+
+    // Indica se as leituras são de fato assíncronas (io_uring) ou síncronas (pread).
+    inline bool uring() const
+    {
+#ifdef ASYNC_IO_URING
+        return ring >= 0;
+#else
+        return false;
+#endif
+    }
+
+    // Quantidade máxima de leituras em voo.
+    inline unsigned depth() const { return queue_depth; }
+
+    // Quantidade de leituras submetidas e ainda não colhidas.
+    inline size_t in_flight() const { return flying; }
+
+    // Enfileira uma leitura. Caso a fila esteja cheia, aguarda antes uma conclusão, que fica disponível em complete().
+    // A requisição deve permanecer válida até ser colhida.
+    void submit(ReadRequest* req)
+    {
+        req->result = 0;
+#ifdef ASYNC_IO_URING
+        if (uring())
+        {
+            while (flying - done.size() >= queue_depth) done.push_back(reap());
+            unsigned tail = *sq_tail, index = tail & *sq_mask;
+            io_uring_sqe* sqe = &sqes[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            req->iov.iov_base = req->buffer;
+            req->iov.iov_len = req->length;
+            sqe->opcode = IORING_OP_READV;
+            sqe->fd = req->fd;
+            sqe->off = req->offset;
+            sqe->addr = (unsigned long) &req->iov;
+            sqe->len = 1;
+            sqe->user_data = (unsigned long) req;
+            sq_array[index] = index;
+            store_release(sq_tail, tail + 1);
+            pending++;
+            flying++;
+            return;
+        }
+#endif
+        finish(req);
+        done.push_back(req);
+        flying++;
+    }
+
+    // Aguarda e retorna uma leitura concluída (com <result> preenchido), ou nullptr se não houver nenhuma em voo.
+    ReadRequest* complete()
+    {
+        if (flying == 0) return nullptr;
+        flying--;
+        if (!done.empty())
+        {
+            auto req = done.front();
+            done.pop_front();
+            return req;
+        }
+#ifdef ASYNC_IO_URING
+        return reap();
+#else
+        return nullptr;
+#endif
+    }
+
+#ifdef ASYNC_IO_URING
+private:
+    // Colhe uma conclusão do anel, submetendo as pendentes e bloqueando se necessário.
+    ReadRequest* reap()
+    {
+        if (pending > 0) enter(0);
+        unsigned head;
+        while ((head = *cq_head) == load_acquire(cq_tail)) enter(1);
+        io_uring_cqe* cqe = &cqes[head & *cq_mask];
+        auto req = (ReadRequest*) cqe->user_data;
+        req->result = cqe->res;
+        store_release(cq_head, head + 1);
+        if (req->result < 0 || (size_t) req->result < req->length) finish(req);
+        return req;
+    }
+public:
+#endif
+
+    // Leitura síncrona avulsa: uma única leitura bloqueante não se beneficia do anel.
+    static long read(const int& fd, const size_t& offset, char* buffer, const size_t& length)
+    {
+        ReadRequest req{fd, offset, length, buffer, 0, {}};
+        finish(&req);
+        return req.result;
+    }
+};
+
+#endif // ASYNC_IO_HPP
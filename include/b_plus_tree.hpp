@@ -9,17 +9,29 @@
 #include <cstdio>
 #include <string>
 #include <initializer_list>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include <optional>
+#include <atomic>
+#include <mutex>
 
 #include "file.hpp"
 #include "node.hpp"
 #include "consts.hpp"
 #include "tabela.hpp"
 #include "stats.hpp"
+#include "instrumentation.hpp"
+#include "scheduler.hpp"
 
 
 // class Tabela;
 // class TupleIterator;
 template <size_t N> class Operador;
+template <size_t N> class SelecaoEmLote;
 
 class BPlusTree;
 
@@ -56,95 +68,190 @@ public:
 
 };
 
+// Parte da árvore B+ independente do fanout: dicionários de códigos, colunas, estatísticas
+// e as operações de consulta, que percorrem as folhas por meio de um LeafCursor.
+// Os nós, cujo tamanho depende do fanout, ficam a cargo de BasicBPlusTree<F>,
+// instanciada para cada um dos fanouts compilados (ver create).
 class BPlusTree
 {
-private:
+protected:
     File<std::fstream> indices;
+    int node_fd;    // descritor somente leitura do arquivo de índices, aberto ao fim da construção (ver build)
     const Tabela& table;
-    std::string directory, codes_directory, search_key;
-    size_t depth, unique_keys;
-    Node root;
+    std::string directory, search_key;
+    std::vector<std::string> columns;   // colunas do índice, na ordem da chave composta
+    std::vector<size_t> unique_codes;   // quantidade de códigos distintos de cada coluna
+    std::vector<std::vector<std::string>> values;   // dicionário reverso (código -> valor) de cada coluna
+    std::vector<std::unordered_map<std::string, size_t>> codes;   // dicionário (valor -> código) de cada coluna, em memória
+    size_t depth, unique_keys;          // unique_keys: quantidade de chaves de busca (completas) distintas
     
     template <size_t N> friend class Operador;
+    template <size_t N> friend class SelecaoEmLote;
+    friend Juncao;
+    friend Tabela;
+    friend Contagem;
+    friend Agrupamento;
 
-    size_t get_code(const std::string& search_key);
+    // Atribui ao parâmetro de referência code o código do valor <search_key> da coluna de posição <part>, sem criá-lo.
+    // Retorna verdadeiro sse o valor possui código, isto é, se ocorre em alguma tupla indexada.
+    // Apenas consulta o dicionário em memória, de modo que pode ser chamado por várias consultas simultâneas.
+    bool find_code(const std::string& search_key, size_t& code, const size_t& part = 0);
 
-    std::string search_dir(const std::string& search_key);
+    // Retorna o código associado ao valor <search_key> da coluna de posição <part> no índice.
+    // Caso o valor ainda não possua código, um novo é criado.
+    size_t get_code(const std::string& search_key, const size_t& part = 0);
 
-    TablePageSystem newResultPage(const std::string& search_key);
+    // Monta a chave de busca composta da tupla especificada.
+    SearchKey get_search_key(const Tuple& tuple);
 
-    
-    std::array<Node, 3> buffer;     // São mantidos na memória 3 nós além da raiz.
-                                    // São essenciais pois abstraem a manipulação do arquivo de índices,
-                                    // sem a qual o código ficaria consideravelmente mais complicado e lento,
-                                    // pois durante a inserção de uma chave na árvore, são utilizados até 3 nós:
-                                    // o nó que recebe a chave, seu pai e um nó de "overflow".
-                                    // Ao mesmo tempo, o uso de memória é irrisório: 3*((MAX_CHILDREN + 3)*sizeof(size_t) + sizeof(bool)),
-                                    // o que não passa de 243 bytes para MAX_CHILDREN = 10.
+    // Conta as chaves de busca distintas percorrendo a lista encadeada de folhas.
+    size_t count_unique_keys();
 
-                                    // TODO: Não carregar mais informações do que o necessário, sobrescrever diretamente campos no arquivo de índices.
+    std::string search_dir(const std::string& search_key);
 
-    // Atualiza o cabeçalho do arquivo de índices
-    // com o endereço da raiz e profundidade atuais.
-    void update_header();
+    // Indica se os nós são lidos com E/S direta e mantidos no cache de aplicação (ver Tabela::direct_io).
+    bool direct_io() const;
+
+    // Atribui os códigos de cada coluna na ordem crescente dos valores (ver compare_values),
+    // de modo que a ordem das chaves na árvore coincida com a dos valores indexados.
+    void assign_codes();
 
     // Insere todos os registros do arquivo de dados na árvore.
     void insert_all();
 
     // Insere uma chave associada ao registro add
     // Retorna falso sse a chave já pertence a árvore
-    bool insert(const Key&k, const size_t& add = 0);
-    
+    virtual bool insert(const Key&k, const size_t& add = 0) = 0;
 
-    // Carrega no buffer especificado (por padrão no primeiro)
-    // a folha correta para a chave especificada.
-    // A chave não necessariamente pertence a essa folha.
-    // Caso não pertença, não pertence a nenhuma outra folha
-    // e pode ser inserida nesta sem violar as propriedades da árvore.
-    // As propriedades da árvore B+ garantem que essa folha seja única.
-    size_t set_leaf(const Key& k, size_t node_id = 0);
+    // Atribui os códigos, insere todos os registros e conta as chaves distintas.
+    // Chamado pelo construtor da implementação, após a criação da raiz.
+    void build();
 
-    // Carrega no buffer especificado (por padrão no primeiro)
-    // a primeira folha que possa conter uma chave com o
-    // search_key especificado. É o ponto de partida
-    // da busca por todas as chaves com um dado ano de colheita,
-    // visto que as chaves formam uma lista encadeada ordenada.
-    // As propriedades da árvore B+ garantem que essa folha seja única.
-    std::array<size_t, 2> set_leaf_weak(const size_t& code, const size_t& node_id = 0);
-
-    // Carrega o nó com a posição <pos> no arquivo de índices
-    // na variável de referência out.
-    // Também define seu atributo pos de acordo.
-    void set_node(const size_t& pos, Node& out);
+    // Lança invalid_argument se a lista de colunas for vazia, tiver mais de MAX_KEY_PARTS colunas,
+    // repetir alguma coluna ou contiver colunas inexistentes na tabela.
+    BPlusTree(const Tabela& table, const std::vector<std::string>& columns);
 
 public:
-    // Construtor único da árvore com parâmetros opcionais dos caminhos dos arquivos de dados e de índices.
-    // Esses parâmetros recebem os valores padrãe abaixo.
-    // A árvore sempre começa com uma raiz vazia e, portanto, profundidade zero.
-    // A raiz inicial é sempre escrita na segunda linha do arquivo de índices,
-    // após o cabeçalho, portanto, no endereço HEADER_WIDTH + 1. 
-    // BPlusTree(const std::string& data_path = "vinhos.csv", const std::string& indices_path = "generated/indices.ssv")
-    //     : indices(indices_path, std::ios_base::in | std::ios_base::out | std::ios_base::trunc), data(data_path, std::ios_base::in), root(HEADER_WIDTH+1), depth(0)
-    // {
-    //     update_header();    // escreve cabeçalho
-    //     indices << root;    // escreve raiz
-    // }
+    // Índice composto sobre a lista ordenada de colunas especificada, com no máximo <fanout> filhos por nó.
+    // O fanout deve ser um dos compilados (ver supported_fanouts); caso contrário, lança invalid_argument.
+    static std::shared_ptr<BPlusTree> create(const Tabela& table, const std::vector<std::string>& columns, const size_t& fanout = MAX_CHILDREN);
 
-    BPlusTree(const Tabela& table, const std::string& search_key);
+    // Fanouts para os quais a árvore é instanciada.
+    static const std::vector<size_t>& supported_fanouts();
+
+    virtual ~BPlusTree() { if (node_fd >= 0) close(node_fd); }
+
+    // quantidade máxima de filhos de um nó interno
+    virtual size_t fanout() const = 0;
 
-    BPlusTree(BPlusTree&& tree);
-    
     // retorna profundidade atual da árvore
     size_t get_depth() { return depth; }
 
+    // Retorna o valor da coluna de posição <part> correspondente ao código especificado.
+    inline const std::string& decode(const size_t& code, const size_t& part = 0) const
+    {
+        return values[part][code];
+    }
+
+    // Cursor sobre as chaves da árvore em ordem crescente, que percorre a lista encadeada de folhas (ponteiros r).
+    // Mantém sua própria cópia do nó corrente, de modo que vários cursores possam percorrer a mesma árvore.
+    // Um cursor recém-criado não está posicionado: deve-se chamar rewind ou seek antes de lê-lo.
+    class LeafCursor
+    {
+    public:
+        size_t ios = 0;     // quantidade de nós carregados pelo cursor
+
+        virtual ~LeafCursor() = default;
+
+        virtual bool valid() const = 0;
+
+        virtual const Key& key() const = 0;
+
+        virtual void next() = 0;
+
+        // Posiciona o cursor na primeira chave da folha mais à esquerda.
+        virtual void rewind() = 0;
+
+        // Posiciona o cursor na primeira chave com prefixo maior ou igual ao especificado.
+        // A folha corrente é reaproveitada, sem descer da raiz, quando certamente contém essa chave,
+        // o que torna baratas as buscas em ordem crescente de prefixos próximos.
+        virtual void seek(const KeyPrefix& prefix) = 0;
+
+        // Posiciona o cursor na primeira chave maior ou igual à especificada (comparador forte), descendo da raiz.
+        virtual void seek_key(const Key& k) = 0;
+    };
+
+    virtual std::unique_ptr<LeafCursor> cursor() = 0;
+
+    // Chaves separadoras dos nós internos com o prefixo especificado, em ordem crescente: dividem as folhas
+    // com o prefixo em trechos contíguos. Os níveis internos são percorridos a partir da raiz, lendo apenas os nós
+    // que cobrem o prefixo, até que se obtenham ao menos <wanted> - 1 separadoras ou se atinja o último nível interno.
+    // Os nós lidos são contabilizados em ios. Retorna um vetor vazio quando o prefixo cabe numa única subárvore folha.
+    virtual std::vector<Key> split_points(const KeyPrefix& prefix, const size_t& wanted, size_t& ios) = 0;
+
     TupleIterator get_tuple_iterator(const std::string& search_key);
     
     TupleIterator operator [] (const std::string& search_key);
 
-    // retorna a quantidade de chaves na árvore com o search_key especificado
-    // Caso as entradas sejam obtidas do terminal, também imprime todos os registros correspondentes.
+    // Soma as contagens de tuplas das chaves com o prefixo especificado, percorrendo apenas as folhas.
+    // Os nós carregados são contabilizados em stats.ios.
+    size_t count(const KeyPrefix& prefix, Stats& stats);
+
+    // Seleciona as tuplas cujo valor da primeira coluna do índice é <search_key>.
+    // Retorna a quantidade de tuplas selecionadas.
     size_t select(const std::string& search_key);
     
+    // Quantidade de colunas do índice, a partir da primeira, restringidas por igualdade nos predicados.
+    // Uma chave composta só pode ser utilizada a partir de um prefixo de suas colunas.
+    // Aceita tanto vetores quanto arrays de colunas.
+    template <typename C>
+    size_t prefix_length(const C& keys) const
+    {
+        size_t n = 0;
+        for (; n < columns.size(); n++)
+        {
+            if (std::find(std::begin(keys), std::end(keys), columns[n]) == std::end(keys)) break;
+        }
+        return n;
+    }
+
+    // Monta o prefixo de chave de busca correspondente aos predicados.
+    // Valores sem código (que não ocorrem na tabela) recebem o próximo código livre, que nenhuma chave possui;
+    // o dicionário não é alterado, de modo que consultas simultâneas possam montar seus prefixos.
+    template <typename C>
+    KeyPrefix get_prefix(const C& keys, const C& values)
+    {
+        KeyPrefix prefix(SearchKey{}, prefix_length(keys));
+        for (size_t i = 0; i < prefix.n; i++)
+        {
+            auto pos = std::find(std::begin(keys), std::end(keys), columns[i]) - std::begin(keys);
+            if (!find_code(std::begin(values)[pos], prefix.parts[i], i)) prefix.parts[i] = unique_codes[i];
+        }
+        return prefix;
+    }
+
+    // Estimativa da quantidade de valores distintos de um prefixo de <n> colunas.
+    // Quanto maior, menos tuplas por chave e, portanto, mais seletivo o índice.
+    size_t estimated_distinct(const size_t& n) const
+    {
+        if (n == 0) return 0;
+        if (n == columns.size()) return unique_keys;
+        size_t distinct = 1;
+        for (size_t i = 0; i < n; i++) distinct *= unique_codes[i];
+        return std::min(distinct, unique_keys);
+    }
+
+    // Custo estimado, em I/Os, de uma seleção pelo prefixo de <n> colunas sobre uma tabela de <table_pages> páginas:
+    // o cabeçalho, a descida até a primeira folha, as demais folhas percorridas e as páginas apontadas pelas chaves.
+    // Supõe tuplas distribuídas uniformemente entre os valores distintos do prefixo.
+    double estimated_cost(const size_t& n, const size_t& table_pages) const
+    {
+        size_t distinct = std::max<size_t>(estimated_distinct(n), 1);
+        double pages = std::min<double>(table_pages, std::ceil((double) table_pages * table.page_capacity / distinct));
+        double leaves = std::max(1.0, std::ceil(pages / (fanout() - 1)));
+        return 1 + depth + (leaves - 1) + pages;
+    }
+
     template <size_t N>
     std::string search_dir(const std::string (&keys)[N], const std::string (&values)[N])
     {
@@ -164,8 +271,8 @@ public:
     template <size_t N>
     TablePageSystem newResultPage(const std::string (&keys)[N], const std::string (&values)[N])
     {
-        auto page = PageSystem(search_dir(keys, values), table.newTuple);
-        // page.clear();
+        std::filesystem::remove_all(search_dir(keys, values));   // descarta resultados de execuções anteriores
+        auto page = PageSystem(search_dir(keys, values), table.newTuple, table.page_capacity);
         return page;
     }
 
@@ -181,64 +288,355 @@ public:
         return true;
     }
 
-    template <size_t N>
-    Stats select(size_t matching_index, const std::string (&keys)[N], const std::string (&values)[N])
+    // Percorre, a partir da posição corrente do cursor, as chaves com o prefixo <code> estritamente menores que <end>
+    // (todas, se não especificada), lendo suas páginas candidatas e passando a <emit> cada página carregada
+    // e as posições de suas tuplas que satisfazem os predicados. Quando o prefixo não cobre todas as colunas do índice,
+    // uma mesma página aparece sob várias chaves completas; cada página é lida e passada a <emit> uma única vez,
+    // na primeira chave em que aparece. As páginas lidas e as descartadas pelos filtros
+    // de Bloom são contabilizadas em stats.ios e stats.skipped; cabe a <emit> contabilizar as tuplas.
+    template <size_t N, typename E>
+    void scan_keys(LeafCursor& cur, const KeyPrefix& code, const std::optional<Key>& end, TablePageSystem& table_page,
+        const std::string (&keys)[N], const std::string (&values)[N], Stats& stats, const E& emit)
     {
-        Stats stats(0, 0, 0);
-        const auto& search_key = values[matching_index];
-        size_t code = get_code(search_key);
-        stats.ios++;
-        stats.ios += set_leaf_weak(code)[1];
-        auto& cur_node = buffer[0];
-        size_t p;
-        if (((LN) cur_node).get_pos_weak(code, p))
+        std::vector<size_t> matches, window, ahead;
+        std::unordered_set<size_t> seen;
+
+        // Avança pelas folhas coletando as páginas candidatas das próximas chaves, até IO_QUEUE_DEPTH delas,
+        // e inicia sua leitura (ver PageSystem::prefetch).
+        auto collect = [&](std::vector<size_t>& pages)
         {
-            PageSystem result_page = newResultPage(keys, values);
-            PageSystem table_page = table.get_page();
-            while (true)
+            pages.clear();
+            for (; cur.valid() && pages.size() < IO_QUEUE_DEPTH; cur.next())
             {
-                if (p < cur_node.m)
+                const Key& key = cur.key();
+                if (Key::weak_comparator(key, code) != 0 || (end && !(key < *end))) break;
+                if (!seen.insert(key.page).second) continue;
+                if (!table.may_match(key.page, keys, values))
                 {
-                    if (cur_node.keys[p].search_key != code) break;
-                    table_page.load_page(cur_node.keys[p].page);
+                    stats.skipped++;
+                    continue;
+                }
+                pages.push_back(key.page);
+            }
+            PhaseTimer timer(Phase::PAGE_FETCH);
+            table_page.prefetch(pages);
+        };
+
+        // Enquanto as páginas de uma janela estão em voo, o percurso das folhas já coleta (e antecipa)
+        // a janela seguinte; as páginas são então consumidas na ordem das chaves.
+        collect(window);
+        while (!window.empty())
+        {
+            collect(ahead);
+            for (const auto& page: window)
+            {
+                {
+                    PhaseTimer timer(Phase::PAGE_FETCH);
+                    table_page.load_page(page);
                     stats.ios++;
                     table_page.load_tuples();
+                }
+                {
+                    PhaseTimer timer(Phase::FILTER);
+                    matches.clear();
                     for (size_t i = 0; i < table_page.buffer_page.occupancy; i++)
                     {
-                        const auto& tuple = table_page[i];
-    
-                        if (matches_restriction(tuple, keys, values))
-                        {
-                            result_page << tuple;
-                            stats.tuples++;
-                        }
+                        if (matches_restriction(table_page[i], keys, values)) matches.push_back(i);
                     }
-                    p++;
-                    continue;
                 }
-                
-                if (cur_node.r == 0) break;
-                set_node(cur_node.r, cur_node);
-                stats.ios++;
-                p = 0;
+                PhaseTimer timer(Phase::MATERIALIZE);
+                emit(table_page, matches);
+            }
+            std::swap(window, ahead);
+        }
+    }
+
+    // Seleção por igualdade sobre o prefixo de colunas do índice restringido pelos predicados.
+    // Os predicados restantes são verificados em cada tupla das páginas apontadas pelo índice.
+    // Com mais de uma thread, as folhas do prefixo são divididas nas separadoras dos nós internos (ver split_points)
+    // e os trechos, processados em paralelo (ver select_chunks); prefixos que cabem numa única subárvore folha
+    // são selecionados sequencialmente. O resultado é o mesmo, na mesma ordem, em ambos os casos.
+    // Os tempos de cada fase (descida, percurso das folhas, leitura das páginas, filtragem e materialização)
+    // são acumulados na instrumentação corrente, se houver.
+    template <size_t N>
+    Stats select(const std::string (&keys)[N], const std::string (&values)[N], const size_t& threads = 1)
+    {
+        Stats stats(0, 0, 0);
+        auto code = get_prefix(keys, values);
+        stats.ios++;
+        if (threads > 1)
+        {
+            std::vector<Key> bounds;
+            {
+                PhaseTimer timer(Phase::DESCENT);
+                bounds = split_points(code, threads * SELECT_CHUNKS_PER_THREAD, stats.ios);
             }
+            if (!bounds.empty()) return select_chunks(keys, values, code, bounds, threads, stats);
+        }
+
+        auto cur = cursor();
+        {
+            PhaseTimer timer(Phase::DESCENT);
+            cur->seek(code);
+        }
+        if (cur->valid() && Key::weak_comparator(cur->key(), code) == 0)
+        {
+            PageSystem result_page = newResultPage(keys, values);
+            PageSystem table_page = table.get_page();
+            scan_keys(*cur, code, std::nullopt, table_page, keys, values, stats,
+                [&](TablePageSystem& page, const std::vector<size_t>& matches)
+                {
+                    for (const auto& i: matches) result_page << page[i];
+                    stats.tuples += matches.size();
+                });
+            PhaseTimer timer(Phase::MATERIALIZE);
             stats.pags = result_page.occupancy;
             result_page.update_header();
             result_page.save_page();
         }
+        stats.ios += cur->ios;
 
         return stats;
     }
 
+    // Seleção paralela das chaves com o prefixo <code>, divididas pelas separadoras <bounds> em trechos
+    // [início, bounds[0]), [bounds[0], bounds[1]), ..., [bounds.back(), fim), que até <threads> tarefas do escalonador
+    // compartilhado (ver Scheduler) reivindicam dinamicamente. Cada tarefa desce da raiz até o início de seu trecho com seu próprio cursor, lê as páginas com seus próprios
+    // descritores (ver Tabela::get_page) e guarda as tuplas selecionadas num buffer do trecho, agrupadas por página;
+    // os buffers são gravados no resultado na ordem dos trechos, assim que todos os anteriores o forem, omitindo
+    // as páginas já gravadas por trechos anteriores (prefixos de índices compostos), como na seleção sequencial.
+    // As estatísticas são acumuladas em <stats>, que já contém as da busca das separadoras.
     template <size_t N>
-    TupleIterator get_tuple_iterator(size_t matching_index, const std::string (&keys)[N], const std::string (&values)[N])
+    Stats select_chunks(const std::string (&keys)[N], const std::string (&values)[N], const KeyPrefix& code,
+        const std::vector<Key>& bounds, const size_t& threads, Stats stats)
     {
-        select(matching_index, keys, values);
-        TupleIterator iter(search_dir(keys, values), table.scheme);
+        PageSystem result_page = newResultPage(keys, values);
+        size_t num_chunks = bounds.size() + 1;
+        std::atomic<size_t> next_chunk(0);
+        using PageRows = std::pair<size_t, std::vector<std::string>>;   // página e tuplas selecionadas dela
+        std::vector<std::vector<PageRows>> done(num_chunks);
+        std::vector<bool> ready(num_chunks, false);
+        std::unordered_set<size_t> written_pages;
+        size_t written = 0;
+        std::mutex output;
+
+        TaskGroup group;
+        for (size_t worker = 0; worker < std::min(threads, num_chunks); worker++)
+        {
+            group.run([&]()
+            {
+                TablePageSystem table_page = table.get_page();
+                Stats local(0, 0, 0);
+                for (size_t chunk; (chunk = next_chunk++) < num_chunks; )
+                {
+                    auto cur = cursor();
+                    {
+                        PhaseTimer timer(Phase::DESCENT);
+                        if (chunk == 0) cur->seek(code);
+                        else cur->seek_key(bounds[chunk - 1]);
+                    }
+                    std::optional<Key> end;
+                    if (chunk < bounds.size()) end = bounds[chunk];
+
+                    std::vector<PageRows> rows;
+                    scan_keys(*cur, code, end, table_page, keys, values, local,
+                        [&](TablePageSystem& page, const std::vector<size_t>& matches)
+                        {
+                            auto& [index, page_rows] = rows.emplace_back(page.index, std::vector<std::string>());
+                            for (const auto& i: matches)
+                            {
+                                std::stringstream row;
+                                row << page[i];
+                                page_rows.push_back(row.str());
+                            }
+                        });
+                    local.ios += cur->ios;
+
+                    std::lock_guard lock(output);
+                    done[chunk] = std::move(rows);
+                    ready[chunk] = true;
+                    PhaseTimer timer(Phase::MATERIALIZE);
+                    for (; written < num_chunks && ready[written]; written++)
+                    {
+                        for (const auto& [index, page_rows]: done[written])
+                        {
+                            if (!written_pages.insert(index).second) continue;
+                            for (const auto& row: page_rows) result_page << row;
+                            stats.tuples += page_rows.size();
+                        }
+                        std::vector<PageRows>().swap(done[written]);
+                    }
+                }
+                std::lock_guard lock(output);
+                stats.ios += local.ios;
+                stats.skipped += local.skipped;
+            });
+        }
+        group.wait();
+
+        PhaseTimer timer(Phase::MATERIALIZE);
+        stats.pags = result_page.occupancy;
+        result_page.update_header();
+        result_page.save_page();
+        return stats;
+    }
+
+    // Seleção em lote: executa de uma só vez várias consultas por igualdade sobre as mesmas colunas <keys>,
+    // cada uma com seus valores, com um único percurso do índice e uma única leitura de cada página de dados.
+    // Os prefixos de busca são sondados em ordem crescente, de modo que sondagens consecutivas reaproveitem a folha
+    // corrente; as páginas candidatas de todas as consultas são então lidas em ordem crescente, antecipadas em
+    // janelas de IO_QUEUE_DEPTH páginas, e cada página lida é filtrada para cada consulta que a referencia.
+    // O resultado de cada consulta é gravado, em ordem de página, em search_dir(keys, values), como em select;
+    // consultas repetidas compartilham o resultado.
+    // Retorna as estatísticas de cada consulta, na ordem recebida, em que ios conta as páginas lidas para a consulta,
+    // ainda que compartilhadas com outras. Os I/Os efetivos do lote (cabeçalho, nós e páginas) e o total de tuplas
+    // e de páginas geradas são acumulados em <total>.
+    template <size_t N>
+    std::vector<Stats> select_batch(const std::string (&keys)[N], const std::vector<std::array<std::string, N>>& queries, Stats& total)
+    {
+        std::array<std::string, N> columns;
+        std::copy(std::begin(keys), std::end(keys), columns.begin());
+        total.ios++;
+
+        // Consultas distintas; as repetidas são mapeadas para a primeira ocorrência.
+        std::map<std::array<std::string, N>, size_t> distinct;
+        std::vector<size_t> query_of(queries.size());
+        std::vector<std::array<std::string, N>> values;
+        for (size_t q = 0; q < queries.size(); q++)
+        {
+            auto [entry, inserted] = distinct.try_emplace(queries[q], values.size());
+            if (inserted) values.push_back(queries[q]);
+            query_of[q] = entry->second;
+        }
+
+        std::vector<Stats> stats(values.size(), Stats(0, 0, 0));
+        std::vector<TablePageSystem> results;
+        for (const auto& value: values)
+        {
+            std::string value_list[N];
+            std::copy(value.begin(), value.end(), value_list);
+            results.push_back(newResultPage(keys, value_list));
+            results.back().release();
+        }
+
+        // Sondagens em ordem crescente de prefixo, reunindo os pares (página, consulta) candidatos.
+        std::vector<std::pair<SearchKey, size_t>> probes;
+        for (size_t d = 0; d < values.size(); d++) probes.emplace_back(get_prefix(columns, values[d]).parts, d);
+        std::sort(probes.begin(), probes.end());
+
+        std::vector<std::pair<size_t, size_t>> requests;
+        auto cur = cursor();
+        {
+            PhaseTimer timer(Phase::LEAF_WALK);
+            size_t n = prefix_length(keys);
+            for (size_t first = 0, last; first < probes.size(); first = last)
+            {
+                for (last = first + 1; last < probes.size() && probes[last].first == probes[first].first; last++);
+                KeyPrefix code(probes[first].first, n);
+                for (cur->seek(code); cur->valid() && Key::weak_comparator(cur->key(), code) == 0; cur->next())
+                {
+                    size_t page = cur->key().page;
+                    for (size_t i = first; i < last; i++)
+                    {
+                        size_t d = probes[i].second;
+                        if (table.may_match(page, columns, values[d])) requests.emplace_back(page, d);
+                        else stats[d].skipped++;
+                    }
+                }
+            }
+        }
+        total.ios += cur->ios;
+        std::sort(requests.begin(), requests.end());
+        requests.erase(std::unique(requests.begin(), requests.end()), requests.end());
+
+        // Páginas distintas, na ordem de leitura, e o início de seus pedidos em <requests>.
+        std::vector<size_t> pages, starts;
+        for (size_t r = 0; r < requests.size(); r++)
+        {
+            if (r > 0 && requests[r].first == requests[r-1].first) continue;
+            pages.push_back(requests[r].first);
+            starts.push_back(r);
+        }
+        starts.push_back(requests.size());
+
+        PageSystem table_page = table.get_page();
+        std::vector<size_t> window;
+        auto collect = [&](const size_t& first)
+        {
+            window.assign(pages.begin() + std::min(first, pages.size()), pages.begin() + std::min(first + IO_QUEUE_DEPTH, pages.size()));
+            PhaseTimer timer(Phase::PAGE_FETCH);
+            table_page.prefetch(window);
+        };
+
+        std::vector<size_t> matches;
+        collect(0);
+        for (size_t p = 0; p < pages.size(); p++)
+        {
+            if (p % IO_QUEUE_DEPTH == 0) collect(p + IO_QUEUE_DEPTH);
+            {
+                PhaseTimer timer(Phase::PAGE_FETCH);
+                table_page.load_page(pages[p]);
+                total.ios++;
+                table_page.load_tuples();
+            }
+            for (size_t r = starts[p]; r < starts[p+1]; r++)
+            {
+                size_t d = requests[r].second;
+                stats[d].ios++;
+                {
+                    PhaseTimer timer(Phase::FILTER);
+                    matches.clear();
+                    for (size_t i = 0; i < table_page.buffer_page.occupancy; i++)
+                    {
+                        bool match = true;
+                        for (size_t k = 0; k < N && match; k++) match = table_page[i][keys[k]] == values[d][k];
+                        if (match) matches.push_back(i);
+                    }
+                }
+                PhaseTimer timer(Phase::MATERIALIZE);
+                for (const auto& i: matches) results[d] << table_page[i];
+                results[d].release();
+                stats[d].tuples += matches.size();
+            }
+        }
+
+        {
+            PhaseTimer timer(Phase::MATERIALIZE);
+            for (size_t d = 0; d < values.size(); d++)
+            {
+                stats[d].pags = results[d].occupancy;
+                results[d].update_header();
+                results[d].save_page();
+                results[d].release();
+                total.pags += stats[d].pags;
+                total.tuples += stats[d].tuples;
+                total.skipped += stats[d].skipped;
+            }
+        }
+
+        std::vector<Stats> per_query;
+        for (const auto& d: query_of) per_query.push_back(stats[d]);
+        return per_query;
+    }
+
+    // Seleção sob demanda (ver Generator): produz as tuplas das páginas apontadas pelas chaves com o prefixo
+    // restringido pelos predicados que satisfazem todos eles, na ordem das chaves, sem gravar resultado algum.
+    // Produz as mesmas tuplas, na mesma ordem, que select. Cada página é lida apenas quando o consumidor chega a ela,
+    // sem leituras antecipadas, de modo que um consumidor que pare cedo (LIMIT) leia apenas as folhas e páginas
+    // de que precisou. O cabeçalho, os nós e as páginas lidos e as páginas descartadas pelos filtros de Bloom são
+    // contabilizados em stats à medida que a iteração avança (as tuplas produzidas ficam a cargo do consumidor);
+    // stats deve sobreviver ao gerador.
+    Generator<Tuple> stream(std::vector<std::string> keys, std::vector<std::string> values, Stats& stats);
+
+    template <size_t N>
+    TupleIterator get_tuple_iterator(const std::string (&keys)[N], const std::string (&values)[N])
+    {
+        select(keys, values);
+        TupleIterator iter(search_dir(keys, values), table.newTuple);
 
         if (iter.reached_end())
         {
-            select(matching_index, keys, values);
+            select(keys, values);
             iter.load_page();
         }
         
@@ -246,4 +644,179 @@ public:
     }
 };
 
+// Árvore B+ com no máximo F filhos por nó interno.
+// Os nós são armazenados no arquivo de índices como registros binários de tamanho fixo sizeof(BasicNode<F>) (ver node.hpp).
+template <size_t F>
+class BasicBPlusTree: public BPlusTree
+{
+private:
+    using Node = BasicNode<F>;
+
+    Node root;
+
+    std::array<Node, 3> buffer;     // São mantidos na memória 3 nós além da raiz.
+                                    // São essenciais pois abstraem a manipulação do arquivo de índices,
+                                    // sem a qual o código ficaria consideravelmente mais complicado e lento,
+                                    // pois durante a inserção de uma chave na árvore, são utilizados até 3 nós:
+                                    // o nó que recebe a chave, seu pai e um nó de "overflow".
+                                    // Ao mesmo tempo, o uso de memória é modesto: 3*sizeof(Node),
+                                    // o que não passa de 3 KiB para F = 10.
+
+                                    // TODO: Não carregar mais informações do que o necessário, sobrescrever diretamente campos no arquivo de índices.
+
+    // Atualiza o cabeçalho do arquivo de índices
+    // com o endereço da raiz e profundidade atuais.
+    void update_header();
+
+    bool insert(const Key&k, const size_t& add = 0) override;
+
+    // Carrega no buffer especificado (por padrão no primeiro)
+    // a folha correta para a chave especificada.
+    // A chave não necessariamente pertence a essa folha.
+    // Caso não pertença, não pertence a nenhuma outra folha
+    // e pode ser inserida nesta sem violar as propriedades da árvore.
+    // As propriedades da árvore B+ garantem que essa folha seja única.
+    size_t set_leaf(const Key& k, size_t node_id = 0);
+
+    // Carrega o nó com a posição <pos> no arquivo de índices
+    // na variável de referência out.
+    // Também define seu atributo pos de acordo.
+    // A posição é recebida por valor, pois costuma ser um campo do próprio nó sobrescrito (ex.: set_node(node.r, node)).
+    // Retorna verdadeiro sse o nó veio do cache de aplicação (modo de E/S direta), sem leitura.
+    bool set_node(const size_t pos, Node& out);
+
+    class Cursor: public LeafCursor
+    {
+    private:
+        BasicBPlusTree& tree;
+        Node node;
+        size_t p;
+        bool positioned;
+
+        // Carrega o nó da posição especificada, contabilizando a leitura no nível <level>.
+        // Ao carregar uma folha, pede ao núcleo a leitura antecipada da sucessora, que ocorre enquanto esta é percorrida
+        // (exceto no modo de E/S direta, em que o cache de páginas do núcleo não é usado).
+        void load(const size_t& pos, const size_t& level)
+        {
+            bool hit = tree.set_node(pos, node);
+            ios++;
+            Instrumentation::node(level, hit);
+            if (node.leaf && node.r != 0 && tree.node_fd >= 0 && !tree.direct_io())
+                posix_fadvise(tree.node_fd, node.r, sizeof(Node), POSIX_FADV_WILLNEED);
+        }
+
+        // Avança sobre folhas esgotadas (ou vazias) até encontrar uma chave ou atingir a última folha.
+        void skip_exhausted()
+        {
+            while (p >= node.m && node.r != 0)
+            {
+                load(node.r, tree.depth);
+                p = 0;
+            }
+        }
+
+        // Desce da raiz até uma folha, seguindo em cada nó interno o ponteiro retornado por <child>.
+        // A raiz é consultada no próprio nó da árvore; só é copiada quando é também a folha.
+        template <typename C>
+        void descend(const C& child)
+        {
+            Instrumentation::node(0, true);
+            if (tree.root.leaf) node = tree.root;
+            else load(child(tree.root), 1);
+            for (size_t level = 2; !node.leaf; level++) load(child(node), level);
+            positioned = true;
+        }
+
+    public:
+        Cursor(BasicBPlusTree& tree): tree(tree), p(0), positioned(false) {}
+
+        Cursor(const Cursor&) = delete;
+
+        bool valid() const override { return positioned && p < node.m; }
+
+        const Key& key() const override { return node.keys[p]; }
+
+        void next() override
+        {
+            if (++p < node.m) return;
+            PhaseTimer timer(Phase::LEAF_WALK);
+            skip_exhausted();
+        }
+
+        void rewind() override
+        {
+            descend([](const Node& n) { return n.ptrs[0]; });
+            p = 0;
+            skip_exhausted();
+        }
+
+        void seek(const KeyPrefix& prefix) override
+        {
+            // A primeira chave com o prefixo certamente está na folha corrente
+            // se a menor chave da folha for menor que o prefixo e a maior, maior ou igual.
+            bool reuse = positioned && node.m > 0 && Key::weak_comparator(node.min(), prefix) < 0
+                && Key::weak_comparator(node.max(), prefix) >= 0;
+            if (!reuse)
+            {
+                descend([&](const Node& n) { return n.get_ptr_weak(prefix); });
+                while (node.r != 0 && (node.m == 0 || Key::weak_comparator(node.max(), prefix) < 0)) load(node.r, tree.depth);
+            }
+            p = node.lanes.count_less(prefix, node.m);
+            skip_exhausted();
+        }
+
+        void seek_key(const Key& k) override
+        {
+            descend([&](const Node& n) { return n.get_ptr(k); });
+            while (node.r != 0 && (node.m == 0 || node.max() < k)) load(node.r, tree.depth);
+            p = node.lanes.count_less(k, node.m);
+            skip_exhausted();
+        }
+    };
+
+public:
+    // A árvore sempre começa com uma raiz vazia e, portanto, profundidade zero.
+    // A raiz inicial é sempre escrita na segunda linha do arquivo de índices,
+    // após o cabeçalho, portanto, no endereço HEADER_WIDTH + 1. 
+    BasicBPlusTree(const Tabela& table, const std::vector<std::string>& columns);
+
+    size_t fanout() const override { return F; }
+
+    std::unique_ptr<LeafCursor> cursor() override { return std::make_unique<Cursor>(*this); }
+
+    std::vector<Key> split_points(const KeyPrefix& prefix, const size_t& wanted, size_t& ios) override
+    {
+        std::vector<Key> points;
+        std::vector<size_t> level_nodes, next_nodes;
+
+        // Coleta as separadoras do nó com o prefixo e os filhos que o cobrem: ptrs[lo..hi].
+        auto visit = [&](const Node& n)
+        {
+            size_t lo = n.lanes.count_less(prefix, n.m), hi = n.lanes.count_less_equal(prefix, n.m);
+            points.insert(points.end(), n.keys.begin() + lo, n.keys.begin() + hi);
+            next_nodes.insert(next_nodes.end(), n.ptrs.begin() + lo, n.ptrs.begin() + hi + 1);
+        };
+
+        if (root.leaf) return points;
+        Instrumentation::node(0, true);
+        visit(root);
+        // Os nós do nível <level> são internos sse level < depth (as folhas estão no nível depth).
+        for (size_t level = 1; level < depth && points.size() + 1 < wanted; level++)
+        {
+            std::swap(level_nodes, next_nodes);
+            next_nodes.clear();
+            Node node;
+            for (const auto& pos: level_nodes)
+            {
+                bool hit = set_node(pos, node);
+                ios++;
+                Instrumentation::node(level, hit);
+                visit(node);
+            }
+        }
+        std::sort(points.begin(), points.end());
+        return points;
+    }
+};
+
 #endif
\ No newline at end of file
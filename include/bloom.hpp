@@ -0,0 +1,75 @@
+#ifndef BLOOM_HPP
+#define BLOOM_HPP
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <cstdint>
+
+#include "consts.hpp"
+
+// Filtros de Bloom de uma coluna, um por página de dados, dimensionados pela capacidade das páginas da tabela:
+// BLOOM_BITS_PER_TUPLE bits por tupla (arredondados para palavras de 64 bits) e a quantidade de hashes
+// que minimiza a taxa de falsos positivos para esse tamanho (cerca de 1% com 10 bits por tupla).
+// Indicam com certeza quando um valor não ocorre numa página, permitindo que ela não seja carregada.
+// São mantidos apenas em memória, com os bits das páginas dispostos consecutivamente: como a tabela é sempre
+// recarregada do csv, filtros gravados numa execução anterior poderiam não corresponder às páginas atuais.
+class BloomFilter
+{
+private:
+    size_t words;       // palavras de 64 bits por página
+    size_t num_hashes;  // bits marcados por valor
+    std::vector<uint64_t> bits;
+
+    // Posição do i-ésimo bit do valor, por hashing duplo: h1 + i*h2.
+    inline size_t bit(const size_t& h1, const size_t& h2, const size_t& i) const
+    {
+        return (h1 + i*h2) % (words * 64);
+    }
+
+    static inline void hashes(const std::string& value, size_t& h1, size_t& h2)
+    {
+        h1 = std::hash<std::string>{}(value);
+        h2 = (h1 >> 17 | h1 << 47) * 0x9e3779b97f4a7c15ULL | 1;   // segundo hash derivado do primeiro, ímpar
+    }
+
+public:
+    // Filtros para páginas de até <page_capacity> tuplas.
+    BloomFilter(const size_t& page_capacity = PAGE_SIZE, const size_t& num_pages = 0):
+        words((std::max<size_t>(page_capacity, 1) * BLOOM_BITS_PER_TUPLE + 63) / 64),
+        num_hashes(std::max<long>(1, std::lround(words * 64.0 / std::max<size_t>(page_capacity, 1) * M_LN2))),
+        bits(num_pages * words, 0)
+    {}
+
+    inline size_t num_pages() const { return bits.size() / words; }
+
+    void add(const size_t& page, const std::string& value)
+    {
+        if (page >= num_pages()) bits.resize((page + 1) * words, 0);
+        size_t h1, h2;
+        hashes(value, h1, h2);
+        for (size_t i = 0; i < num_hashes; i++)
+        {
+            auto b = bit(h1, h2, i);
+            bits[page*words + b/64] |= 1ULL << (b % 64);
+        }
+    }
+
+    // Retorna falso apenas se o valor certamente não ocorre na página.
+    bool may_contain(const size_t& page, const std::string& value) const
+    {
+        if (page >= num_pages()) return true;
+        size_t h1, h2;
+        hashes(value, h1, h2);
+        for (size_t i = 0; i < num_hashes; i++)
+        {
+            auto b = bit(h1, h2, i);
+            if (!(bits[page*words + b/64] & (1ULL << (b % 64)))) return false;
+        }
+        return true;
+    }
+};
+
+#endif // BLOOM_HPP
@@ -4,7 +4,20 @@
 // Macros de parâmetros constantes.
 
 #define GEN_DIR "./generated/"
-#define PAGE_SIZE 12
+#define PAGE_SIZE 12         // capacidade padrão (em tuplas) das páginas; cada tabela pode escolher a sua.
+#define PAGE_SLOT_SIZE 4096 // tamanho (em bytes) da página de cabeçalho e tamanho inicial dos slots de página dos segmentos.
+#define SEGMENT_PAGES 65536 // slots de página por arquivo de segmento (ver PageSystem).
+#define JOIN_BATCH 1024     // quantidade de tuplas externas por lote de sondagens da junção indexada.
+#define MORSEL_PAGES 64     // páginas por fragmento (morsel) reivindicado de cada vez pelas threads da varredura paralela.
+#define SELECT_CHUNKS_PER_THREAD 4   // trechos de folhas por thread buscados pela seleção paralela (ver BPlusTree::split_points).
+#define HASH_JOIN_RADIX_BITS 6          // a junção hash usa 2^HASH_JOIN_RADIX_BITS partições por tabela.
+#define HASH_JOIN_MEMORY (64 << 20)     // orçamento de memória (em bytes) das partições da junção hash;
+                                        // partições que excedam sua cota são despejadas em disco.
+#define SORT_MEMORY (64 << 20)          // tamanho máximo (em bytes) das execuções da ordenação externa.
+#define BLOOM_BITS_PER_TUPLE 10    // bits por tupla dos filtros de Bloom de cada página (ver BloomFilter).
+#define ASYNC_IO 1          // 0 desativa o io_uring; as leituras em lote passam a ser feitas com pread (ver AsyncIO).
+#define IO_QUEUE_DEPTH 32   // máximo de leituras de páginas em voo por thread.
+#define PAGE_CACHE_BYTES (64 << 20)     // capacidade (em bytes) do cache de aplicação do modo de E/S direta (ver PageCache).
 
 #define FILE 0
 #define TERMINAL 1
@@ -13,9 +26,9 @@
 // Se INPUT_SRC == TERMINAL, ela será obtida por interações com o usuário na linha de comando. 
 #define INPUT_SRC FILE
 
-#define MAX_CHILDREN 10     // quantidade máxima de filhos de um nó interno.
+#define MAX_CHILDREN 10     // quantidade padrão máxima de filhos de um nó interno (ver BPlusTree::create).
+#define MAX_KEY_PARTS 3     // quantidade máxima de colunas de um índice composto.
+#define SIMD_KEY_SEARCH 1   // 0 desativa a busca vetorizada (AVX2) nos nós, ver KeyLanes.
 #define HEADER_WIDTH 100    // Comprimento do cabeçalho do arquivo de índices.
                             // Deve ser longo o suficiente de modo a comportar os campos que serão inseridos no cabeçalho.
-#define LINE_WIDTH (100*(MAX_CHILDREN) + 10) // Comprimento das linhas do arquivo de índices que representam os nós da árvore.
-                                            // Deve ser grande o suficiente de modo a comportar os campos de qualquer nó.
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define CSV_HPP
 
 #include <string>
+#include <sstream>
 #include <vector>
 
 template <typename T>
@@ -36,5 +36,13 @@ public:
         this->seekg(pos);
         std::getline(*this, line, sep);
     }
+
+    // Lê <n> bytes a partir da posição especificada diretamente na memória apontada por <out>.
+    void read_at(const size_t& pos, char* out, const size_t& n)
+    {
+        this->clear();
+        this->seekg(pos);
+        this->read(out, n);
+    }
 };
 #endif
\ No newline at end of file
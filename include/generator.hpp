@@ -0,0 +1,139 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+// Gerador preguiçoso baseado em corrotinas, no estilo de std::generator (indisponível na biblioteca padrão usada):
+// a corrotina só é executada à medida que o consumidor avança, até o próximo co_yield, de modo que nada é
+// calculado (nem lido do disco) antes de ser pedido, e interromper a iteração encerra a corrotina, liberando
+// seus recursos (ex.: os sistemas de páginas abertos por ela).
+// Os valores produzidos não são copiados: o iterador referencia o objeto passado a co_yield, válido até o próximo avanço.
+//     Generator<int> naturais() { for (int i = 0; ; i++) co_yield i; }
+//     for (const auto& n: limit(naturais(), 10)) std::cout << n << '\n';
+template <typename T>
+class Generator
+{
+public:
+    struct promise_type
+    {
+        const T* current = nullptr;
+        std::exception_ptr error;
+
+        Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        std::suspend_always yield_value(const T& value) noexcept
+        {
+            current = std::addressof(value);
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() { error = std::current_exception(); }
+
+        // Os geradores são síncronos: co_await não é permitido em seu corpo.
+        template <typename U>
+        std::suspend_never await_transform(U&&) = delete;
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    class iterator
+    {
+    private:
+        Handle coroutine;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = const T&;
+        using pointer = const T*;
+
+        iterator(): coroutine(nullptr) {}
+
+        explicit iterator(const Handle& coroutine): coroutine(coroutine) {}
+
+        iterator& operator ++ ()
+        {
+            Generator::resume(coroutine);
+            return *this;
+        }
+
+        void operator ++ (int) { ++*this; }
+
+        const T& operator * () const { return *coroutine.promise().current; }
+
+        const T* operator -> () const { return coroutine.promise().current; }
+
+        friend bool operator == (const iterator& it, std::default_sentinel_t)
+        {
+            return !it.coroutine || it.coroutine.done();
+        }
+    };
+
+    Generator(Generator&& other) noexcept: coroutine(std::exchange(other.coroutine, nullptr)) {}
+
+    Generator& operator = (Generator&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (coroutine) coroutine.destroy();
+            coroutine = std::exchange(other.coroutine, nullptr);
+        }
+        return *this;
+    }
+
+    Generator(const Generator&) = delete;
+
+    ~Generator()
+    {
+        if (coroutine) coroutine.destroy();
+    }
+
+    // Inicia a corrotina, executando-a até o primeiro valor. Deve ser chamado uma única vez.
+    // Exceções lançadas pela corrotina são relançadas aqui ou no avanço do iterador.
+    iterator begin()
+    {
+        resume(coroutine);
+        return iterator(coroutine);
+    }
+
+    std::default_sentinel_t end() { return {}; }
+
+private:
+    Handle coroutine;
+
+    explicit Generator(const Handle& coroutine): coroutine(coroutine) {}
+
+    static void resume(const Handle& coroutine)
+    {
+        if (!coroutine || coroutine.done()) return;
+        coroutine.resume();
+        auto& error = coroutine.promise().error;
+        if (error) std::rethrow_exception(std::exchange(error, nullptr));
+    }
+};
+
+// Os <n> primeiros valores do gerador (LIMIT n): a fonte não é avançada além do n-ésimo valor.
+template <typename T>
+Generator<T> limit(Generator<T> source, const size_t n)
+{
+    if (n == 0) co_return;
+    size_t produced = 0;
+    for (const auto& value: source)
+    {
+        co_yield value;
+        if (++produced == n) co_return;
+    }
+}
+
+#endif // GENERATOR_HPP
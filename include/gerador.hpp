@@ -0,0 +1,250 @@
+#ifndef GERADOR_HPP
+#define GERADOR_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <ostream>
+#include <algorithm>
+#include <stdexcept>
+
+// Geração de tabelas sintéticas com assimetria (Zipf), correlação entre colunas e chaves estrangeiras válidas.
+
+// Amostrador de Zipf sobre {0, ..., n-1}: P(k) é proporcional a 1/(k+1)^s.
+// Com s = 0 a distribuição é uniforme e nenhuma tabela é alocada.
+class ZipfSampler
+{
+private:
+    size_t n;
+    std::vector<double> cdf;
+
+public:
+    ZipfSampler(const size_t& n, const double& s): n(n)
+    {
+        if (s == 0) return;
+        cdf.resize(n);
+        double total = 0;
+        for (size_t k = 0; k < n; k++) cdf[k] = total += 1 / std::pow(k + 1, s);
+        for (auto& c: cdf) c /= total;
+    }
+
+    template <typename RNG>
+    size_t operator () (RNG& rng) const
+    {
+        if (cdf.empty()) return rng() % n;
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        return std::min<size_t>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin(), n - 1);
+    }
+};
+
+// Especificação de uma coluna gerada, no formato TIPO[:PARÂMETROS]:
+//   seq                          0, 1, 2, ... (chaves primárias)
+//   uniform:MIN:MAX              inteiro uniforme em [MIN, MAX] (MAX >= MIN)
+//   zipf:CARD:S[:OFFSET]         OFFSET + k, k em {0, ..., CARD-1} com assimetria S; serve de chave estrangeira
+//                                para tabelas com CARD tuplas e chaves seq (0 é o valor mais frequente)
+//   corr:COLUNA:P:CARD[:OFFSET]  com probabilidade P, valor determinado pelo da COLUNA (mesma tupla);
+//                                caso contrário, uniforme em OFFSET + {0, ..., CARD-1}; COLUNA pode ser outra
+//                                coluna corr, desde que as dependências não formem ciclos
+//   label                        rótulo textual aleatório (ex.: jolly-barolo)
+//   text:LEN                     LEN letras maiúsculas aleatórias
+//   choice:A|B|C                 um dos valores listados, uniformemente
+// CARD deve ser positivo e P estar em [0, 1]; especificações inválidas lançam invalid_argument.
+class ColumnGenerator
+{
+private:
+    std::string kind;
+    long long offset, low, high;
+    size_t card, length, other;
+    double probability;
+    std::string other_name;
+    std::vector<std::string> choices;
+    std::unique_ptr<ZipfSampler> zipf;
+
+    static std::vector<std::string> split(const std::string& str, const char& sep)
+    {
+        std::vector<std::string> parts;
+        std::stringstream ss(str);
+        std::string part;
+        while (std::getline(ss, part, sep)) parts.push_back(part);
+        return parts;
+    }
+
+public:
+    // Gerador da coluna <name> (usado para rejeitar dependências de si mesma) segundo a especificação.
+    ColumnGenerator(const std::string& spec, const std::string& name = ""):
+        offset(0), low(0), high(0), card(1), length(0), other(0), probability(0)
+    {
+        auto params = split(spec, ':');
+        if (params.empty()) throw std::invalid_argument("especificação de coluna vazia");
+        kind = params[0];
+
+        auto require = [&](size_t n)
+        {
+            if (params.size() < n) throw std::invalid_argument("parâmetros insuficientes: " + spec);
+        };
+        auto check = [&](const bool& valid, const std::string& what)
+        {
+            if (!valid) throw std::invalid_argument(what + ": " + spec);
+        };
+
+        if (kind == "uniform")
+        {
+            require(3);
+            low = std::stoll(params[1]);
+            high = std::stoll(params[2]);
+            check(high >= low, "MAX menor que MIN");
+        }
+        else if (kind == "zipf")
+        {
+            require(3);
+            card = std::stoul(params[1]);
+            check(card > 0, "CARD deve ser positivo");
+            if (params.size() > 3) offset = std::stoll(params[3]);
+            zipf = std::make_unique<ZipfSampler>(card, std::stod(params[2]));
+        }
+        else if (kind == "corr")
+        {
+            require(4);
+            other_name = params[1];
+            probability = std::stod(params[2]);
+            card = std::stoul(params[3]);
+            if (params.size() > 4) offset = std::stoll(params[4]);
+            check(other_name != name, "coluna correlacionada consigo mesma");
+            check(probability >= 0 && probability <= 1, "P fora de [0, 1]");
+            check(card > 0, "CARD deve ser positivo");
+        }
+        else if (kind == "text")
+        {
+            require(2);
+            length = std::stoul(params[1]);
+        }
+        else if (kind == "choice")
+        {
+            require(2);
+            choices = split(params[1], '|');
+            check(!choices.empty(), "nenhum valor listado");
+        }
+        else if (kind != "seq" && kind != "label") throw std::invalid_argument("tipo de coluna desconhecido: " + kind);
+    }
+
+    // Coluna da qual este valor depende (apenas para corr), que deve ser gerada antes.
+    inline const std::string& dependency() const { return other_name; }
+
+    inline void resolve(const size_t& position) { other = position; }
+
+    template <typename RNG>
+    std::string next(RNG& rng, const size_t& row, const std::vector<std::string>& values) const
+    {
+        static const std::vector<std::string> adjectives {"jolly", "roaring", "smoggy", "light", "fixed", "hot", "ebony", "cream",
+            "concrete", "vibrant", "agile", "shy", "auburn", "canary", "freezing", "right"};
+        static const std::vector<std::string> nouns {"barolo", "claret", "champagne", "chianti", "blanc", "grappa", "zinfandel",
+            "sauvignon", "muscat", "barbaresco", "arneis", "cabernet"};
+
+        if (kind == "seq") return std::to_string(row);
+        if (kind == "uniform") return std::to_string(low + (long long) (rng() % (high - low + 1)));
+        if (kind == "zipf") return std::to_string(offset + (long long) (*zipf)(rng));
+        if (kind == "corr")
+        {
+            double u = std::uniform_real_distribution<double>(0, 1)(rng);
+            size_t k = u < probability? std::hash<std::string>{}(values[other]) % card: rng() % card;
+            return std::to_string(offset + (long long) k);
+        }
+        if (kind == "label") return adjectives[rng() % adjectives.size()] + "-" + nouns[rng() % nouns.size()];
+        if (kind == "text")
+        {
+            std::string text(length, 'A');
+            for (auto& c: text) c = 'A' + rng() % 26;
+            return text;
+        }
+        return choices[rng() % choices.size()];
+    }
+};
+
+// Gera <rows> tuplas em csv (com cabeçalho) no fluxo de saída.
+// <specs> associa cada coluna do cabeçalho à sua especificação; colunas omitidas são uniform:0:99.
+inline void generate_table(std::ostream& out, const std::vector<std::string>& header,
+    const std::map<std::string, std::string>& specs, const size_t& rows, const size_t& seed)
+{
+    std::vector<ColumnGenerator> columns;
+    for (const auto& name: header)
+    {
+        auto spec = specs.find(name);
+        columns.emplace_back(spec == specs.end()? "uniform:0:99": spec->second, name);
+    }
+
+    std::vector<long> dependency(columns.size(), -1);
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+        if (columns[i].dependency().empty()) continue;
+        auto pos = std::find(header.begin(), header.end(), columns[i].dependency());
+        if (pos == header.end()) throw std::invalid_argument("coluna inexistente: " + columns[i].dependency());
+        columns[i].resolve(pos - header.begin());
+        dependency[i] = pos - header.begin();
+    }
+
+    // Ordem topológica por rodadas: primeiro as colunas independentes, depois as que dependem apenas delas,
+    // e assim por diante, cada rodada na ordem do cabeçalho. Uma rodada sem colunas prontas indica um ciclo.
+    std::vector<size_t> order;
+    std::vector<bool> generated(columns.size(), false);
+    while (order.size() < columns.size())
+    {
+        std::vector<size_t> ready;
+        for (size_t i = 0; i < columns.size(); i++)
+        {
+            if (!generated[i] && (dependency[i] < 0 || generated[dependency[i]])) ready.push_back(i);
+        }
+        if (ready.empty()) throw std::invalid_argument("dependências cíclicas entre colunas correlacionadas");
+        for (const auto& i: ready)
+        {
+            generated[i] = true;
+            order.push_back(i);
+        }
+    }
+
+    std::mt19937_64 rng(seed);
+    std::vector<std::string> values(columns.size());
+
+    for (size_t i = 0; i < header.size(); i++) out << (i == 0? "": ",") << header[i];
+    out << '\n';
+
+    for (size_t row = 0; row < rows; row++)
+    {
+        for (const auto& i: order) values[i] = columns[i].next(rng, row, values);
+        for (size_t i = 0; i < values.size(); i++) out << (i == 0? "": ",") << values[i];
+        out << '\n';
+    }
+}
+
+// Parâmetros das tabelas vinho, uva e pais geradas em conjunto.
+// As chaves estrangeiras (uva_id, pais_producao_id, pais_origem_id) sempre referenciam tuplas existentes.
+struct WineDataset
+{
+    size_t vinhos = 500, uvas = 75, paises = 5;
+    double skew = 1.0;          // assimetria de Zipf das chaves estrangeiras
+    double correlation = 0.0;   // probabilidade de ano_producao ser determinado por pais_producao_id
+
+    std::map<std::string, std::string> pais() const
+    {
+        return {{"pais_id", "seq"}, {"nome", "label"}, {"sigla", "text:3"}};
+    }
+
+    std::map<std::string, std::string> uva() const
+    {
+        return {{"uva_id", "seq"}, {"nome", "label"}, {"tipo", "choice:branco|tinto|rose"},
+            {"ano_colheita", "uniform:1900:2020"}, {"pais_origem_id", "zipf:" + std::to_string(paises) + ":" + std::to_string(skew)}};
+    }
+
+    std::map<std::string, std::string> vinho() const
+    {
+        return {{"vinho_id", "seq"}, {"rotulo", "label"},
+            {"ano_producao", "corr:pais_producao_id:" + std::to_string(correlation) + ":121:1900"},
+            {"uva_id", "zipf:" + std::to_string(uvas) + ":" + std::to_string(skew)},
+            {"pais_producao_id", "zipf:" + std::to_string(paises) + ":" + std::to_string(skew)}};
+    }
+};
+
+#endif // GERADOR_HPP
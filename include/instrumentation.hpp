@@ -0,0 +1,152 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <ctime>
+
+// Instrumentação por consulta: tempos (de parede e de CPU) por fase, bytes lidos e gravados,
+// acertos e faltas dos caches de nós e de páginas e nós visitados por nível da árvore.
+// Os contadores são preenchidos pela camada de armazenamento (PageSystem, BPlusTree) sempre que houver
+// uma instrumentação corrente na thread, definida por um InstrumentationScope durante a execução do operador.
+// Os contadores são atômicos, de modo que threads auxiliares de um mesmo operador possam compartilhá-los.
+
+enum class Phase { DESCENT, LEAF_WALK, PAGE_FETCH, FILTER, MATERIALIZE };
+
+struct Instrumentation
+{
+    static constexpr size_t NUM_PHASES = 5;
+    static constexpr size_t MAX_LEVELS = 32;
+
+    std::array<std::atomic<uint64_t>, NUM_PHASES> wall_ns {}, cpu_ns {};
+    std::atomic<uint64_t> bytes_read {0}, bytes_written {0};
+    std::atomic<uint64_t> node_hits {0}, node_misses {0};   // faltas correspondem a leituras do arquivo de índices
+    std::atomic<uint64_t> page_hits {0}, page_misses {0};   // faltas correspondem a leituras de páginas
+    std::atomic<uint64_t> page_writes {0};
+    std::atomic<uint64_t> rows_decoded {0};                 // tuplas decodificadas das páginas lidas
+    std::array<std::atomic<uint64_t>, MAX_LEVELS> nodes_per_level {};
+
+    // Instrumentação corrente da thread (nula fora de um InstrumentationScope).
+    static Instrumentation*& current()
+    {
+        thread_local Instrumentation* instrumentation = nullptr;
+        return instrumentation;
+    }
+
+    void reset()
+    {
+        for (auto& t: wall_ns) t = 0;
+        for (auto& t: cpu_ns) t = 0;
+        for (auto& n: nodes_per_level) n = 0;
+        bytes_read = bytes_written = node_hits = node_misses = page_hits = page_misses = page_writes = rows_decoded = 0;
+    }
+
+    // Registra a visita a um nó no nível especificado (a raiz está no nível 0).
+    // Acertos são nós já em memória, como a raiz; faltas, nós lidos do arquivo de índices.
+    static inline void node(const size_t& level, const bool& hit)
+    {
+        auto instrumentation = current();
+        if (!instrumentation) return;
+        (hit? instrumentation->node_hits: instrumentation->node_misses)++;
+        if (level < MAX_LEVELS) instrumentation->nodes_per_level[level]++;
+    }
+
+    static inline void page(const bool& hit)
+    {
+        auto instrumentation = current();
+        if (instrumentation) (hit? instrumentation->page_hits: instrumentation->page_misses)++;
+    }
+
+    static inline void rows(const size_t& n)
+    {
+        auto instrumentation = current();
+        if (instrumentation) instrumentation->rows_decoded += n;
+    }
+
+    static inline void read(const size_t& bytes)
+    {
+        auto instrumentation = current();
+        if (instrumentation) instrumentation->bytes_read += bytes;
+    }
+
+    static inline void write(const size_t& bytes)
+    {
+        auto instrumentation = current();
+        if (!instrumentation) return;
+        instrumentation->bytes_written += bytes;
+        instrumentation->page_writes++;
+    }
+
+    // Exporta os contadores como um objeto JSON.
+    std::string json() const
+    {
+        static const char* phases[NUM_PHASES] = {"descent", "leaf_walk", "page_fetch", "filter", "materialize"};
+        std::stringstream ss;
+        ss << "{\"phases\":{";
+        for (size_t i = 0; i < NUM_PHASES; i++)
+        {
+            if (i != 0) ss << ",";
+            ss << "\"" << phases[i] << "\":{\"wall_ms\":" << wall_ns[i] / 1e6 << ",\"cpu_ms\":" << cpu_ns[i] / 1e6 << "}";
+        }
+        ss << "},\"bytes_read\":" << bytes_read << ",\"bytes_written\":" << bytes_written
+           << ",\"node_cache\":{\"hits\":" << node_hits << ",\"misses\":" << node_misses << "}"
+           << ",\"page_cache\":{\"hits\":" << page_hits << ",\"misses\":" << page_misses << "}"
+           << ",\"page_writes\":" << page_writes << ",\"rows_decoded\":" << rows_decoded << ",\"nodes_per_level\":[";
+
+        size_t levels = MAX_LEVELS;
+        while (levels > 0 && nodes_per_level[levels - 1] == 0) levels--;
+        for (size_t i = 0; i < levels; i++) ss << (i == 0? "": ",") << nodes_per_level[i];
+        ss << "]}";
+        return ss.str();
+    }
+};
+
+// Define a instrumentação corrente da thread enquanto existir, restaurando a anterior ao ser destruído.
+class InstrumentationScope
+{
+private:
+    Instrumentation* previous;
+
+public:
+    InstrumentationScope(Instrumentation& instrumentation): previous(Instrumentation::current())
+    {
+        Instrumentation::current() = &instrumentation;
+    }
+
+    ~InstrumentationScope() { Instrumentation::current() = previous; }
+};
+
+// Acumula na instrumentação corrente os tempos de parede e de CPU (da thread) decorridos
+// entre sua construção e destruição, na fase especificada. Sem instrumentação corrente, nada é medido.
+class PhaseTimer
+{
+private:
+    Instrumentation* instrumentation;
+    size_t phase;
+    std::chrono::steady_clock::time_point wall_start;
+    timespec cpu_start;
+
+    static inline uint64_t ns(const timespec& t) { return t.tv_sec * 1000000000ULL + t.tv_nsec; }
+
+public:
+    PhaseTimer(const Phase& phase): instrumentation(Instrumentation::current()), phase((size_t) phase)
+    {
+        if (!instrumentation) return;
+        wall_start = std::chrono::steady_clock::now();
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start);
+    }
+
+    ~PhaseTimer()
+    {
+        if (!instrumentation) return;
+        timespec cpu_end;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_end);
+        instrumentation->wall_ns[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wall_start).count();
+        instrumentation->cpu_ns[phase] += ns(cpu_end) - ns(cpu_start);
+    }
+};
+
+#endif // INSTRUMENTATION_HPP
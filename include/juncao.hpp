@@ -0,0 +1,743 @@
+#ifndef JUNCAO_HPP
+#define JUNCAO_HPP
+
+#include <algorithm>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <queue>
+#include <limits>
+#include <functional>
+
+#include "b_plus_tree.hpp"
+#include "csv.hpp"
+#include "stats.hpp"
+#include "scheduler.hpp"
+
+// Algoritmos de junção disponíveis.
+// AUTOMATICO usa intercalação (merge) quando ambas as tabelas possuem índice na coluna de junção,
+// laços aninhados indexados quando apenas a interna possui, e hash particionado caso contrário.
+enum class Algoritmo { AUTOMATICO, LACOS_INDEXADOS, HASH, MERGE };
+
+// Junção por igualdade: SELECT * FROM tabela_1, tabela_2 WHERE col_tab_1 = col_tab_2
+// As tuplas geradas concatenam os campos da tupla externa (tabela_1) com os da interna (tabela_2),
+// e o esquema resultante qualifica cada coluna com o nome da sua tabela (ex.: vinho.uva_id, uva.uva_id).
+class Juncao
+{
+private:
+    Tabela &outer, &inner;
+    const std::string outer_key, inner_key;
+    Algoritmo algoritmo;
+    Scheme scheme;
+    std::function<Tuple()> newTuple;
+    Stats stats;
+
+    // Partição de um dos lados da junção hash.
+    // As tuplas são mantidas na memória como pares (valor de junção, tupla em csv)
+    // até que a partição exceda sua cota do orçamento de memória, quando são despejadas em disco.
+    struct Particao
+    {
+        std::mutex mutex;                           // protege rows, bytes e total
+        std::mutex spill_mutex;                     // serializa as gravações no despejo
+        std::vector<std::pair<std::string, std::string>> rows;
+        size_t bytes = 0;                           // bytes das tuplas em memória
+        size_t total = 0;                           // bytes de todas as tuplas, em memória ou despejadas
+        std::unique_ptr<TablePageSystem> spill;     // criado no primeiro despejo
+
+        inline bool empty() const { return total == 0; }
+    };
+
+    using Particoes = std::vector<Particao>;
+
+    // Fonte de grupos de tuplas com mesmo valor de junção, em ordem crescente de valor (ver compare_values).
+    class GroupSource
+    {
+    public:
+        virtual ~GroupSource() {}
+        virtual bool valid() = 0;
+        virtual const std::string& value() = 0;         // valor de junção do grupo corrente
+        virtual void skip() = 0;                        // descarta o grupo corrente sem carregar suas tuplas
+        virtual std::vector<std::string> rows() = 0;    // consome o grupo corrente, retornando suas tuplas em csv
+        virtual size_t io_count() = 0;
+    };
+
+    // Grupos obtidos da lista de folhas de um índice cuja primeira coluna é a de junção.
+    // Como os códigos preservam a ordem dos valores, as folhas já estão ordenadas pelo valor de junção,
+    // e páginas de dados só são carregadas para os grupos consumidos por rows().
+    class IndexGroups: public GroupSource
+    {
+    private:
+        Tabela& table;
+        BPlusTree& tree;
+        const std::string& key;
+        std::unique_ptr<BPlusTree::LeafCursor> cursor;
+        TablePageSystem page;
+        size_t loaded_page, ios;
+        bool loaded;
+
+        inline size_t code() { return cursor->key().search_key[0]; }
+
+    public:
+        IndexGroups(Tabela& table, BPlusTree& tree, const std::string& key):
+            table(table), tree(tree), key(key), cursor(tree.cursor()), page(table.get_page()), loaded_page(0), ios(0), loaded(false)
+        {
+            cursor->rewind();
+        }
+
+        bool valid() override { return cursor->valid(); }
+
+        const std::string& value() override { return tree.decode(code()); }
+
+        void skip() override
+        {
+            size_t cur_code = code();
+            while (cursor->valid() && code() == cur_code) cursor->next();
+        }
+
+        std::vector<std::string> rows() override
+        {
+            const std::string& cur_value = value();
+            size_t cur_code = code();
+            std::vector<size_t> pages;
+            while (cursor->valid() && code() == cur_code)
+            {
+                pages.push_back(cursor->key().page);
+                cursor->next();
+            }
+            std::sort(pages.begin(), pages.end());
+            pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+            std::vector<std::string> out;
+            for (const auto& cur_page: pages)
+            {
+                // grupos vizinhos frequentemente compartilham a última página carregada
+                if (!loaded || cur_page != loaded_page)
+                {
+                    page.load_page(cur_page);
+                    page.load_tuples();
+                    loaded_page = cur_page;
+                    loaded = true;
+                    ios++;
+                }
+
+                for (size_t i = 0; i < page.buffer_page.occupancy; i++)
+                {
+                    if (page[i][key] != cur_value) continue;
+                    std::stringstream row;
+                    row << page[i];
+                    out.push_back(row.str());
+                }
+            }
+            return out;
+        }
+
+        size_t io_count() override { return ios + cursor->ios; }
+    };
+
+    // Grupos obtidos de uma sequência de páginas já ordenada pela coluna de junção (ver external_sort).
+    class SortedGroups: public GroupSource
+    {
+    private:
+        const std::string& key;
+        TupleIterator iter;
+        size_t remaining, page, ios;
+        std::string cur_value;
+
+        void advance()
+        {
+            iter++;
+            remaining--;
+            if (remaining > 0 && iter.cur_page_index != page)
+            {
+                page = iter.cur_page_index;
+                ios++;
+            }
+        }
+
+    public:
+        SortedGroups(const std::string& directory, const std::function<Tuple()>& newTuple, const std::string& key, const size_t& count):
+            key(key), iter(directory, newTuple), remaining(count), page(0), ios(1)
+        {}
+
+        bool valid() override { return remaining > 0; }
+
+        const std::string& value() override { return cur_value = iter[key]; }
+
+        void skip() override
+        {
+            std::string group = value();
+            while (valid() && iter[key] == group) advance();
+        }
+
+        std::vector<std::string> rows() override
+        {
+            std::string group = value();
+            std::vector<std::string> out;
+            while (valid() && iter[key] == group)
+            {
+                std::stringstream row;
+                row << *iter;
+                out.push_back(row.str());
+                advance();
+            }
+            return out;
+        }
+
+        size_t io_count() override { return ios; }
+    };
+
+    std::string result_directory()
+    {
+        return outer.result_directory + outer.name + "." + outer_key + "=" + inner.name + "." + inner_key + "/";
+    }
+
+    // Processa um lote de tuplas externas, agrupadas pelo código do valor de junção no índice interno.
+    // Os códigos são sondados em ordem crescente, de modo que sondagens consecutivas
+    // reaproveitem a folha corrente, e cada página interna referenciada é carregada uma única vez por lote.
+    void probe_batch(BPlusTree& tree, std::unordered_map<std::string, std::vector<std::string>>& batch, TablePageSystem& result_page)
+    {
+        std::vector<size_t> codes;
+        for (const auto& [value, rows]: batch)
+        {
+            size_t code;
+            if (tree.find_code(value, code)) codes.push_back(code);
+        }
+        std::sort(codes.begin(), codes.end());
+
+        // Páginas internas que contêm ao menos uma tupla com algum dos códigos do lote.
+        // O cursor reaproveita a folha corrente sempre que ela contém o próximo código sondado.
+        std::vector<size_t> pages;
+        auto cursor = tree.cursor();
+        for (const auto& code: codes)
+        {
+            for (cursor->seek(code); cursor->valid() && Key::weak_comparator(cursor->key(), code) == 0; cursor->next())
+            {
+                pages.push_back(cursor->key().page);
+            }
+        }
+        stats.ios += cursor->ios;
+
+        std::sort(pages.begin(), pages.end());
+        pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+        TablePageSystem inner_page = inner.get_page();
+        for (const auto& page: pages)
+        {
+            inner_page.load_page(page);
+            stats.ios++;
+            inner_page.load_tuples();
+
+            for (size_t i = 0; i < inner_page.buffer_page.occupancy; i++)
+            {
+                const auto& inner_tuple = inner_page[i];
+                auto match = batch.find(inner_tuple[inner_key]);
+                if (match == batch.end()) continue;
+
+                std::stringstream inner_fields;
+                inner_fields << inner_tuple;
+                for (const auto& outer_fields: match->second)
+                {
+                    result_page << outer_fields + "," + inner_fields.str();
+                    stats.tuples++;
+                }
+            }
+        }
+    }
+
+    // Cota de memória de cada partição; é também o tamanho máximo da tabela hash construída por uma tarefa.
+    static constexpr size_t PARTITION_MEMORY = HASH_JOIN_MEMORY >> HASH_JOIN_RADIX_BITS;
+
+    // Partição do valor no nível de particionamento especificado: cada nível usa os HASH_JOIN_RADIX_BITS bits
+    // seguintes do hash, de modo que o reparticionamento de uma partição distribua suas tuplas.
+    static inline size_t partition_of(const std::string& value, const size_t& level = 0)
+    {
+        return (std::hash<std::string>{}(value) >> (level * HASH_JOIN_RADIX_BITS)) & ((1 << HASH_JOIN_RADIX_BITS) - 1);
+    }
+
+    // Acrescenta à partição as tuplas acumuladas localmente por uma tarefa,
+    // despejando a partição em disco caso ela exceda a cota de memória especificada.
+    // As tuplas despejadas são retiradas da partição sob sua trava, mas gravadas após liberá-la,
+    // de modo que as demais tarefas continuem acrescentando tuplas à partição durante a gravação.
+    void flush(Particao& part, std::vector<std::pair<std::string, std::string>>& local,
+        const Tabela& table, const std::string& spill_dir, std::atomic<size_t>& ios, const size_t& quota = PARTITION_MEMORY)
+    {
+        std::vector<std::pair<std::string, std::string>> evicted;
+        {
+            std::lock_guard lock(part.mutex);
+            for (auto& row: local)
+            {
+                part.bytes += row.first.size() + row.second.size();
+                part.total += row.first.size() + row.second.size();
+                part.rows.push_back(std::move(row));
+            }
+            local.clear();
+
+            if (part.bytes <= quota) return;
+            evicted.swap(part.rows);
+            part.bytes = 0;
+        }
+
+        std::lock_guard lock(part.spill_mutex);
+        if (!part.spill) part.spill = std::make_unique<TablePageSystem>(spill_dir, table.newTuple);
+        size_t before = part.spill->get_occupancy();
+        for (const auto& row: evicted) *part.spill << row.second;
+        ios += part.spill->get_occupancy() - before;
+    }
+
+    // Grava as últimas páginas de cada despejo, que ainda estão no buffer.
+    static void close_spills(Particoes& parts, std::atomic<size_t>& ios)
+    {
+        for (auto& part: parts)
+        {
+            if (!part.spill) continue;
+            part.spill->update_header();
+            part.spill->save_page();
+            ios++;
+        }
+    }
+
+    // Particiona uma tabela pela coluna de junção.
+    // O intervalo de páginas é dividido em um trecho por thread do escalonador, cada um lido por uma tarefa
+    // com um TupleIterator próprio.
+    void particionar(Tabela& table, const std::string& key, Particoes& parts, const std::string& spill_dir,
+        std::atomic<size_t>& ios)
+    {
+        TaskGroup group;
+        size_t num_pages = table.get_page().get_occupancy();
+        size_t chunk = (num_pages + group.workers() - 1) / group.workers();
+
+        for (size_t first = 0; first < num_pages; first += chunk)
+        {
+            size_t last = std::min(first + chunk, num_pages);
+            group.run([&, first, last]()
+            {
+                std::vector<std::vector<std::pair<std::string, std::string>>> local(parts.size());
+                auto iter = table[first];
+                ios++;
+                for (size_t page = first; !iter.reached_end() && iter.cur_page_index < last; iter++)
+                {
+                    if (iter.cur_page_index != page)
+                    {
+                        page = iter.cur_page_index;
+                        ios++;
+                    }
+
+                    std::stringstream row;
+                    row << *iter;
+                    const auto& value = iter[key];
+                    auto p = partition_of(value);
+                    local[p].emplace_back(value, row.str());
+                    if (local[p].size() == JOIN_BATCH)
+                        flush(parts[p], local[p], table, spill_dir + std::to_string(p) + "/", ios);
+                }
+
+                for (size_t p = 0; p < parts.size(); p++)
+                {
+                    if (!local[p].empty()) flush(parts[p], local[p], table, spill_dir + std::to_string(p) + "/", ios);
+                }
+            });
+        }
+        group.wait();
+        close_spills(parts, ios);
+    }
+
+    // Redistribui as tuplas de uma partição em subpartições, pelos bits do hash do nível especificado.
+    // As subpartições são gravadas diretamente em disco (a partição original já excedia sua cota),
+    // retendo em memória apenas os lotes locais.
+    void reparticionar(Particao& part, const Tabela& table, const std::string& key, const size_t& level,
+        Particoes& subparts, const std::string& spill_dir, std::atomic<size_t>& ios)
+    {
+        std::vector<std::vector<std::pair<std::string, std::string>>> local(subparts.size());
+        visit(part, table, key, ios, [&](const std::string& value, const std::string& row)
+        {
+            auto p = partition_of(value, level);
+            local[p].emplace_back(value, row);
+            if (local[p].size() == JOIN_BATCH) flush(subparts[p], local[p], table, spill_dir + std::to_string(p) + "/", ios, 0);
+        });
+        for (size_t p = 0; p < subparts.size(); p++)
+        {
+            if (!local[p].empty()) flush(subparts[p], local[p], table, spill_dir + std::to_string(p) + "/", ios, 0);
+        }
+        close_spills(subparts, ios);
+    }
+
+    // Percorre todas as tuplas de uma partição, tanto as despejadas quanto as mantidas em memória.
+    void visit(Particao& part, const Tabela& table, const std::string& key, std::atomic<size_t>& ios,
+        const std::function<void(const std::string&, const std::string&)>& f)
+    {
+        if (part.spill)
+        {
+            size_t num_pages = part.spill->get_occupancy();
+            for (size_t page = 0; page < num_pages; page++)
+            {
+                TablePageSystem spilled(part.spill->directory, page, table.newTuple);
+                spilled.load_tuples();
+                ios++;
+                for (size_t i = 0; i < spilled.buffer_page.occupancy; i++)
+                {
+                    std::stringstream row;
+                    row << spilled[i];
+                    f(spilled[i][key], row.str());
+                }
+            }
+        }
+
+        for (const auto& [value, row]: part.rows) f(value, row);
+    }
+
+    // Junta um par de partições do nível especificado, passando a <emit> cada tupla gerada.
+    // Partições internas que excedem a cota de memória são reparticionadas recursivamente, junto com a externa,
+    // pelos bits seguintes do hash. Quando isso não as divide (ex.: um único valor de junção frequente)
+    // ou os bits do hash se esgotam, a tabela hash é construída em blocos de até PARTITION_MEMORY bytes,
+    // e a partição externa é sondada uma vez por bloco.
+    void juntar(Particao& inner_part, Particao& outer_part, const size_t& level, const std::string& spill_dir,
+        std::atomic<size_t>& ios, const std::function<void(std::string&&)>& emit)
+    {
+        if (inner_part.empty() || outer_part.empty()) return;
+
+        if (inner_part.total > PARTITION_MEMORY && (level + 2) * HASH_JOIN_RADIX_BITS <= std::numeric_limits<size_t>::digits)
+        {
+            Particoes inner_subparts(1 << HASH_JOIN_RADIX_BITS), outer_subparts(1 << HASH_JOIN_RADIX_BITS);
+            reparticionar(inner_part, inner, inner_key, level + 1, inner_subparts, spill_dir + "interna/", ios);
+            size_t nonempty = std::count_if(inner_subparts.begin(), inner_subparts.end(), [](const Particao& part){ return !part.empty(); });
+            if (nonempty > 1)
+            {
+                reparticionar(outer_part, outer, outer_key, level + 1, outer_subparts, spill_dir + "externa/", ios);
+                for (size_t p = 0; p < inner_subparts.size(); p++)
+                {
+                    juntar(inner_subparts[p], outer_subparts[p], level + 1, spill_dir + std::to_string(p) + "/", ios, emit);
+                }
+                std::filesystem::remove_all(spill_dir);
+                return;
+            }
+            std::filesystem::remove_all(spill_dir);
+        }
+
+        std::unordered_multimap<std::string, std::string> hash_table;
+        size_t bytes = 0;
+        auto probe = [&]()
+        {
+            if (hash_table.empty()) return;
+            visit(outer_part, outer, outer_key, ios, [&](const std::string& value, const std::string& row)
+            {
+                auto [first, last] = hash_table.equal_range(value);
+                for (auto match = first; match != last; match++) emit(row + "," + match->second);
+            });
+            hash_table.clear();
+            bytes = 0;
+        };
+        visit(inner_part, inner, inner_key, ios, [&](const std::string& value, const std::string& row)
+        {
+            hash_table.emplace(value, row);
+            bytes += value.size() + row.size();
+            if (bytes > PARTITION_MEMORY) probe();
+        });
+        probe();
+    }
+
+    // Junção hash particionada em paralelo: ambas as tabelas são particionadas pelos bits menos significativos
+    // do hash do valor de junção; em seguida, cada par de partições é construído (lado interno)
+    // e sondado (lado externo) por uma tarefa independente (ver juntar), que grava as tuplas geradas
+    // no resultado em lotes de JOIN_BATCH.
+    void executar_hash()
+    {
+        std::atomic<size_t> ios(0);
+        std::string spill_dir = result_directory() + "spill/";
+        Particoes outer_parts(1 << HASH_JOIN_RADIX_BITS), inner_parts(1 << HASH_JOIN_RADIX_BITS);
+
+        particionar(inner, inner_key, inner_parts, spill_dir + "interna/", ios);
+        particionar(outer, outer_key, outer_parts, spill_dir + "externa/", ios);
+
+        TablePageSystem result_page(result_directory(), newTuple);
+        std::mutex result_mutex;
+        std::atomic<size_t> tuples(0);
+
+        TaskGroup group;
+        for (size_t p = 0; p < outer_parts.size(); p++)
+        {
+            group.run([&, p]()
+            {
+                std::vector<std::string> out;
+                auto write = [&]()
+                {
+                    tuples += out.size();
+                    std::lock_guard lock(result_mutex);
+                    for (const auto& row: out) result_page << row;
+                    out.clear();
+                };
+                juntar(inner_parts[p], outer_parts[p], 0, spill_dir + "sub/" + std::to_string(p) + "/", ios,
+                    [&](std::string&& row)
+                    {
+                        out.push_back(std::move(row));
+                        if (out.size() == JOIN_BATCH) write();
+                    });
+                write();
+            });
+        }
+        group.wait();
+
+        std::filesystem::remove_all(spill_dir);
+
+        stats.ios += ios;
+        stats.tuples += tuples;
+        stats.pags = result_page.occupancy;
+        result_page.update_header();
+        result_page.save_page();
+    }
+
+    // Ordena a tabela pela coluna de junção por ordenação externa: execuções (runs) de até SORT_MEMORY bytes
+    // são ordenadas em memória e gravadas em disco, e depois intercaladas numa única sequência.
+    // Atribui ao parâmetro de referência sorted o diretório da sequência ordenada e retorna sua quantidade de tuplas.
+    size_t external_sort(Tabela& table, const std::string& key, const std::string& directory, std::string& sorted)
+    {
+        std::vector<std::pair<std::string, std::string>> run;
+        size_t bytes = 0, runs = 0, count = 0;
+
+        auto write_run = [&]()
+        {
+            std::stable_sort(run.begin(), run.end(), [](const auto& a, const auto& b){ return compare_values(a.first, b.first) < 0; });
+            TablePageSystem out(directory + "run" + std::to_string(runs++) + "/", table.newTuple);
+            for (const auto& row: run) out << row.second;
+            out.update_header();
+            out.save_page();
+            stats.ios += out.occupancy;
+            run.clear();
+            bytes = 0;
+        };
+
+        size_t page = 0;
+        auto iter = table.get_tuple_iterator();
+        stats.ios++;
+        for (; !iter.reached_end(); iter++)
+        {
+            if (iter.cur_page_index != page)
+            {
+                page = iter.cur_page_index;
+                stats.ios++;
+            }
+
+            std::stringstream row;
+            row << *iter;
+            run.emplace_back(iter[key], row.str());
+            bytes += run.back().first.size() + run.back().second.size();
+            count++;
+            if (bytes > SORT_MEMORY) write_run();
+        }
+        if (!run.empty()) write_run();
+
+        sorted = directory + "run0/";
+        if (runs <= 1) return count;
+
+        // Intercalação das execuções com uma fila de prioridade de (valor, execução).
+        using Head = std::pair<std::string, size_t>;
+        auto greater = [](const Head& a, const Head& b){ return compare_values(a.first, b.first) > 0; };
+        std::priority_queue<Head, std::vector<Head>, decltype(greater)> heap(greater);
+        std::vector<std::unique_ptr<TupleIterator>> readers;
+        std::vector<size_t> pages(runs, 0);
+
+        for (size_t i = 0; i < runs; i++)
+        {
+            readers.push_back(std::make_unique<TupleIterator>(directory + "run" + std::to_string(i) + "/", table.newTuple));
+            stats.ios++;
+            heap.emplace((*readers[i])[key], i);
+        }
+
+        sorted = directory + "sorted/";
+        TablePageSystem out(sorted, table.newTuple);
+        while (!heap.empty())
+        {
+            auto i = heap.top().second;
+            heap.pop();
+            auto& reader = *readers[i];
+
+            std::stringstream row;
+            row << *reader;
+            out << row.str();
+
+            reader++;
+            if (reader.reached_end()) continue;
+            if (reader.cur_page_index != pages[i])
+            {
+                pages[i] = reader.cur_page_index;
+                stats.ios++;
+            }
+            heap.emplace(reader[key], i);
+        }
+        out.update_header();
+        out.save_page();
+        stats.ios += out.occupancy;
+
+        return count;
+    }
+
+    // Fonte de grupos ordenados de uma tabela: a lista de folhas do índice da coluna de junção, se houver,
+    // ou a tabela ordenada externamente, caso contrário.
+    std::unique_ptr<GroupSource> groups(Tabela& table, const std::string& key, const std::string& sort_dir)
+    {
+        auto tree = table.find_index(key);
+        if (tree) return std::make_unique<IndexGroups>(table, *tree, key);
+
+        std::string sorted;
+        size_t count = external_sort(table, key, sort_dir, sorted);
+        return std::make_unique<SortedGroups>(sorted, table.newTuple, key, count);
+    }
+
+    // Junção por intercalação: percorre os grupos de ambas as tabelas em ordem crescente de valor de junção,
+    // simultaneamente, materializando apenas os grupos com valores coincidentes.
+    void executar_merge()
+    {
+        std::string sort_dir = result_directory() + "sort/";
+        auto outer_groups = groups(outer, outer_key, sort_dir + "externa/");
+        auto inner_groups = groups(inner, inner_key, sort_dir + "interna/");
+        TablePageSystem result_page(result_directory(), newTuple);
+
+        while (outer_groups->valid() && inner_groups->valid())
+        {
+            int comp = compare_values(outer_groups->value(), inner_groups->value());
+            if (comp < 0) outer_groups->skip();
+            else if (comp > 0) inner_groups->skip();
+            else
+            {
+                auto outer_rows = outer_groups->rows();
+                auto inner_rows = inner_groups->rows();
+                for (const auto& outer_row: outer_rows)
+                {
+                    for (const auto& inner_row: inner_rows) result_page << outer_row + "," + inner_row;
+                }
+                stats.tuples += outer_rows.size() * inner_rows.size();
+            }
+        }
+
+        std::filesystem::remove_all(sort_dir);
+
+        stats.ios += outer_groups->io_count() + inner_groups->io_count();
+        stats.pags = result_page.occupancy;
+        result_page.update_header();
+        result_page.save_page();
+    }
+
+public:
+    Juncao(Tabela& outer, Tabela& inner, const std::string& outer_key, const std::string& inner_key,
+        Algoritmo algoritmo = Algoritmo::AUTOMATICO)
+        : outer(outer), inner(inner), outer_key(outer_key), inner_key(inner_key), algoritmo(algoritmo), stats(0, 0, 0)
+    {
+        for (const auto& column: outer.scheme) scheme.push_back(outer.name + "." + column);
+        for (const auto& column: inner.scheme) scheme.push_back(inner.name + "." + column);
+        newTuple = [this](){ return Tuple(scheme); };
+    }
+
+    void executar()
+    {
+        stats = Stats(0, 0, 0);
+        std::filesystem::remove_all(result_directory());
+
+        auto tree = inner.find_index(inner_key);
+        auto chosen = algoritmo;
+        if (chosen == Algoritmo::AUTOMATICO)
+        {
+            if (tree && outer.find_index(outer_key)) chosen = Algoritmo::MERGE;
+            else if (tree) chosen = Algoritmo::LACOS_INDEXADOS;
+            else chosen = Algoritmo::HASH;
+        }
+
+        if (chosen == Algoritmo::MERGE) executar_merge();
+        else if (chosen == Algoritmo::HASH || !tree) executar_hash();
+        else executar_lacos_indexados(*tree);
+    }
+
+    // Junção de laços aninhados indexada: percorre a tabela externa e, a cada JOIN_BATCH tuplas,
+    // sonda o índice da coluna de junção da tabela interna.
+    void executar_lacos_indexados(BPlusTree& tree)
+    {
+        TablePageSystem result_page(result_directory(), newTuple);
+        std::unordered_map<std::string, std::vector<std::string>> batch;
+        size_t batched = 0, last_page = 0;
+
+        auto iter = outer.get_tuple_iterator();
+        stats.ios++;
+        for (; !iter.reached_end(); iter++)
+        {
+            if (iter.cur_page_index != last_page)
+            {
+                last_page = iter.cur_page_index;
+                stats.ios++;
+            }
+
+            std::stringstream outer_fields;
+            outer_fields << *iter;
+            batch[iter[outer_key]].push_back(outer_fields.str());
+
+            if (++batched == JOIN_BATCH)
+            {
+                probe_batch(tree, batch, result_page);
+                batch.clear();
+                batched = 0;
+            }
+        }
+        if (batched > 0) probe_batch(tree, batch, result_page);
+
+        stats.pags = result_page.occupancy;
+        result_page.update_header();
+        result_page.save_page();
+    }
+
+    // Junção sob demanda por laços aninhados indexados, sem gravar resultado: para cada tupla externa, lida sob demanda
+    // (ver Tabela::tuplas), as tuplas internas correspondentes são obtidas do índice da coluna de junção da tabela
+    // interna (ver BPlusTree::stream) e combinadas numa tupla do esquema qualificado. A ordem é a da tabela externa,
+    // e não a de executar, que sonda o índice em lotes; parar a iteração cedo evita as sondagens restantes.
+    // Exige índice na coluna de junção da tabela interna. As estatísticas são zeradas ao iniciar a iteração
+    // e acumuladas durante ela. A junção deve sobreviver ao gerador.
+    Generator<Tuple> tuplas()
+    {
+        auto tree = inner.find_index(inner_key);
+        if (!tree) throw std::logic_error("junção sob demanda sem índice em " + inner.name + "." + inner_key);
+        stats = Stats(0, 0, 0);
+        Tuple joined(scheme);
+        for (const auto& outer_tuple: outer.tuplas(stats))
+        {
+            for (const auto& column: outer.scheme) joined.fields[outer.name + "." + column] = outer_tuple[column];
+
+            Stats probe(0, 0, 0);
+            for (const auto& inner_tuple: tree->stream({inner_key}, {outer_tuple[outer_key]}, probe))
+            {
+                for (const auto& column: inner.scheme) joined.fields[inner.name + "." + column] = inner_tuple[column];
+                stats.tuples++;
+                co_yield joined;
+            }
+            stats.ios += probe.ios - 1;     // o cabeçalho do índice já está em memória
+        }
+    }
+
+    void salvarTuplasGeradas(const std::string& path)
+    {
+        std::fstream out(path, std::ios::in | std::ios::out | std::ios::trunc);
+        salvarTuplasGeradas(out);
+    }
+
+    // Escreve as tuplas geradas, em csv com cabeçalho, no fluxo especificado.
+    void salvarTuplasGeradas(std::ostream& out)
+    {
+        out << csv(scheme) << '\n';
+        TablePageSystem result_page(result_directory(), newTuple);
+        result_page.copy_to(out);
+        stats.ios += result_page.occupancy;
+    }
+
+    inline size_t numPagsGeradas()
+    {
+        return stats.pags;
+    }
+
+    inline size_t numIOExecutados()
+    {
+        return stats.ios;
+    }
+
+    inline size_t numTuplasGeradas()
+    {
+        return stats.tuples;
+    }
+};
+
+#endif // JUNCAO_HPP
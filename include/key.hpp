@@ -1,22 +1,45 @@
 #ifndef KEY_HPP
 #define KEY_HPP
 #include <string>
+#include <array>
+
+#include "consts.hpp"
+
+// Chave de busca composta: códigos das colunas do índice, na ordem em que foram declaradas.
+// Índices de coluna única usam apenas a primeira parte, as demais permanecem nulas.
+using SearchKey = std::array<size_t, MAX_KEY_PARTS>;
+
+// Prefixo de chave de busca, utilizado nas buscas por igualdade em índices compostos.
+// Apenas as <n> primeiras partes são consideradas nas comparações.
+struct KeyPrefix
+{
+    SearchKey parts;
+    size_t n;
+
+    KeyPrefix(const SearchKey& parts, const size_t& n): parts(parts), n(n) {}
+    // Conversão implícita a partir de um código simples (índices de coluna única).
+    KeyPrefix(const size_t& code): parts{code}, n(1) {}
+};
 
 // Chave da estrutura de índices.
 struct Key
 {
-    size_t search_key;    // Chave de busca
+    SearchKey search_key;    // Chave de busca
     size_t page;    // Chave primária, utilizada para diferenciar entre chaves com mesma chave de busca
                         // é a solução adotada pelo livro para o problema das chaves duplicadas.
+    size_t count;   // Quantidade de tuplas da página com essa chave de busca.
+                    // Não participa das comparações; permite contagens sem acessar as páginas de dados.
 
     // Construtores:
-    Key(const size_t& search_key, const size_t& page):
-        search_key(search_key), page(page)
+    Key(const SearchKey& search_key, const size_t& page, const size_t& count = 1):
+        search_key(search_key), page(page), count(count)
     {}
-Key(const size_t& search_key): Key(search_key, 0) {}
+    Key(const size_t& search_key, const size_t& page): Key(SearchKey{search_key}, page) {}
+    Key(const size_t& search_key): Key(search_key, 0) {}
     Key(): Key(0) {}
 
     // Operadores de comparação que definem ordem total sobre essas chaves.
+    // As chaves de busca são comparadas lexicograficamente, parte a parte.
     inline bool operator == (const Key& k) const
     {
         return search_key == k.search_key && page == k.page;
@@ -53,7 +76,8 @@ Key(const size_t& search_key): Key(search_key, 0) {}
     template <typename OS>
     inline friend OS& operator << (OS& os, const Key& k)
     {
-        return os << k.search_key << ' ' << k.page;
+        for (const auto& part: k.search_key) os << part << ' ';
+        return os << k.page << ' ' << k.count;
     }
 
     // Operador de extração de fluxos de entrada
@@ -62,18 +86,22 @@ Key(const size_t& search_key): Key(search_key, 0) {}
     template <typename IS>
     inline friend IS& operator >> (IS& is, Key& k)
     {
-        is >> k.search_key;
+        for (auto& part: k.search_key) is >> part;
         is >> k.page;
+        is >> k.count;
         return is;
     }
 
     // Comparador fraco (em constraste aos comparadores fortes definidos acima).
-    // Compara apenas a chave de busca, necessário para as operações de busca do enunciado.
-    static inline int weak_comparator(const Key& k, const size_t& search_key)
+    // Compara apenas as partes do prefixo da chave de busca, necessário para as operações de busca do enunciado.
+    static inline int weak_comparator(const Key& k, const KeyPrefix& prefix)
     {
-        if (k.search_key < search_key) return -1;
-        if (k.search_key == search_key) return 0;
-        return 1;
+        for (size_t i = 0; i < prefix.n; i++)
+        {
+            if (k.search_key[i] < prefix.parts[i]) return -1;
+            if (k.search_key[i] > prefix.parts[i]) return 1;
+        }
+        return 0;
     }
 };
-#endif
\ No newline at end of file
+#endif
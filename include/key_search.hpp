@@ -0,0 +1,134 @@
+#ifndef KEY_SEARCH_HPP
+#define KEY_SEARCH_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "key.hpp"
+#include "consts.hpp"
+
+#if SIMD_KEY_SEARCH && defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define KEY_SEARCH_AVX2 1
+#endif
+
+// Chaves de um nó dispostas em estrutura de arrays: uma faixa por parte da chave de busca e uma para a página.
+// As buscas contam, sem desvios, quantas chaves antecedem a chave (ou prefixo) procurada, comparando
+// 4 chaves por instrução AVX2 quando o processador as suporta; caso contrário, faz-se busca binária escalar.
+// Deve ser atualizada (assign) sempre que as chaves do nó forem alteradas.
+template <size_t NK>
+struct KeyLanes
+{
+    static constexpr size_t LANES = MAX_KEY_PARTS + 1;      // partes da chave de busca e página
+    static constexpr size_t CAPACITY = (NK + 3) / 4 * 4;    // múltiplo da largura AVX2 (4 inteiros de 64 bits)
+
+    alignas(32) std::array<std::array<uint64_t, CAPACITY>, LANES> lanes;
+
+    void assign(const std::array<Key, NK>& keys, const size_t& m)
+    {
+        for (size_t i = 0; i < m; i++)
+        {
+            for (size_t j = 0; j < MAX_KEY_PARTS; j++) lanes[j][i] = keys[i].search_key[j];
+            lanes[MAX_KEY_PARTS][i] = keys[i].page;
+        }
+    }
+
+    // Quantidade de chaves, entre as <m> primeiras, estritamente menores que o prefixo,
+    // isto é, posição da primeira chave com prefixo maior ou igual (comparador fraco).
+    inline size_t count_less(const KeyPrefix& prefix, const size_t& m) const
+    {
+        return rank(prefix.parts.data(), prefix.n, false, m);
+    }
+
+    // Quantidade de chaves com prefixo menor ou igual ao especificado.
+    inline size_t count_less_equal(const KeyPrefix& prefix, const size_t& m) const
+    {
+        return rank(prefix.parts.data(), prefix.n, true, m);
+    }
+
+    // Quantidade de chaves estritamente menores que k (comparador forte: chave de busca e página).
+    inline size_t count_less(const Key& k, const size_t& m) const
+    {
+        auto probe = probe_of(k);
+        return rank(probe.data(), LANES, false, m);
+    }
+
+    // Quantidade de chaves menores ou iguais a k.
+    inline size_t count_less_equal(const Key& k, const size_t& m) const
+    {
+        auto probe = probe_of(k);
+        return rank(probe.data(), LANES, true, m);
+    }
+
+private:
+    static inline std::array<uint64_t, LANES> probe_of(const Key& k)
+    {
+        std::array<uint64_t, LANES> probe;
+        for (size_t j = 0; j < MAX_KEY_PARTS; j++) probe[j] = k.search_key[j];
+        probe[MAX_KEY_PARTS] = k.page;
+        return probe;
+    }
+
+    // Compara lexicograficamente as <parts> primeiras faixas da chave i com <probe>.
+    inline bool precedes(const size_t& i, const uint64_t* probe, const size_t& parts, const bool& or_equal) const
+    {
+        for (size_t j = 0; j < parts; j++)
+        {
+            if (lanes[j][i] != probe[j]) return lanes[j][i] < probe[j];
+        }
+        return or_equal;
+    }
+
+    // Como as chaves estão ordenadas, as que precedem <probe> formam um prefixo da sequência.
+    size_t rank_scalar(const uint64_t* probe, const size_t& parts, const bool& or_equal, const size_t& m) const
+    {
+        size_t i = 0, j = m;
+        while (i < j)
+        {
+            size_t c = (i + j) / 2;
+            if (precedes(c, probe, parts, or_equal)) i = c + 1;
+            else j = c;
+        }
+        return i;
+    }
+
+#ifdef KEY_SEARCH_AVX2
+    __attribute__((target("avx2")))
+    size_t rank_avx2(const uint64_t* probe, const size_t& parts, const bool& or_equal, const size_t& m) const
+    {
+        // inverte o bit de sinal para comparar inteiros sem sinal com a comparação com sinal do AVX2
+        const __m256i sign = _mm256_set1_epi64x((long long) 0x8000000000000000ULL);
+        __m256i targets[LANES];
+        for (size_t j = 0; j < parts; j++) targets[j] = _mm256_xor_si256(_mm256_set1_epi64x((long long) probe[j]), sign);
+
+        size_t count = 0;
+        for (size_t i = 0; i < m; i += 4)
+        {
+            __m256i less = _mm256_setzero_si256(), equal = _mm256_set1_epi64x(-1);
+            for (size_t j = 0; j < parts; j++)
+            {
+                __m256i lane = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*) &lanes[j][i]), sign);
+                less = _mm256_or_si256(less, _mm256_and_si256(equal, _mm256_cmpgt_epi64(targets[j], lane)));
+                equal = _mm256_and_si256(equal, _mm256_cmpeq_epi64(targets[j], lane));
+            }
+            if (or_equal) less = _mm256_or_si256(less, equal);
+
+            unsigned mask = _mm256_movemask_pd(_mm256_castsi256_pd(less));
+            if (m - i < 4) mask &= (1u << (m - i)) - 1;
+            count += __builtin_popcount(mask);
+        }
+        return count;
+    }
+#endif
+
+    inline size_t rank(const uint64_t* probe, const size_t& parts, const bool& or_equal, const size_t& m) const
+    {
+#ifdef KEY_SEARCH_AVX2
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        if (avx2) return rank_avx2(probe, parts, or_equal, m);
+#endif
+        return rank_scalar(probe, parts, or_equal, m);
+    }
+};
+
+#endif // KEY_SEARCH_HPP
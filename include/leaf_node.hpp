@@ -3,84 +3,51 @@
 
 #include <cstdio>
 #include <array>
-#include <sstream>
 #include "key.hpp"
 #include "misc.hpp"
+#include "key_search.hpp"
 
-template <size_t NK> // <NK> e <NP> são, resp., os números máximos de chaves e de ponteiros do nó;
-                    // Embora o número máximo de ponts. seja exatamente um a mais que o de chaves,
-                    // a escolha independente desses limites foi adotada por uma questão de compatibilidade com a superclasse Node.
+// Operações de folha sobre os campos do nó <N> (m, keys, l, r e lanes), que as herda (CRTP).
+// Assim como InternalNode, não possui atributos próprios.
+template <class N, size_t NK> // <NK> é o número máximo de chaves da folha.
 struct LeafNode
 {
-    size_t& m;
-    std::array<Key, NK>& keys;
-
-    size_t &l, &r;
-
-    LeafNode(size_t& m, std::array<Key, NK>& keys, size_t& l, size_t& r)
-        : m(m), keys(keys), l(l), r(r)
-    {}
-
-    LeafNode<NK>& operator << (std::stringstream& ss)
-    {
-        ss >> l >> r >> m;
-
-        for (int i = 0; i < m; i++)
-        {
-            ss >> keys[i];
-        }
-
-        return *this;
-    }
-
-    template <size_t _NK>
-    inline friend std::stringstream& operator >> (std::stringstream& ss, LeafNode<_NK>& node)
-    {
-        node << ss;
-        return ss;
-    }
+    inline N& self() { return static_cast<N&>(*this); }
+    inline const N& self() const { return static_cast<const N&>(*this); }
 
     // retorna posição apropriada à inserção da chave k,
     // de modo que todas e apenas as chaves menores que k antecedam a posição escolhida.
     // Logo, se nenhuma chave dessa folha for menor que k, k deve ser inserida na primeira posição;
     // já no caso em que k é maior que todas as chaves, a posição retornada é m (supõe-se que a folha não está cheia).
-    size_t find_pos(const Key& k)
+    size_t find_pos(const Key& k) const
     {
-        if (m == 0) return 0;
-        auto p = binary_search(k, keys, m);
-        if (keys[p] < k) p++;
-        return p;
+        return self().lanes.count_less(k, self().m);
     }
 
     // Atribui ao parâmetro de referência p a posição da primeira chave com campo de busca ano_colheita, caso exista.
-    // Retorna verdadeiro sse há alguma chave com tal campo de busca na folha.   
-    bool get_pos_weak(const size_t& ano_colheita, size_t& p)
+    // Retorna verdadeiro sse há alguma chave com tal campo de busca na folha.
+    bool get_pos_weak(const KeyPrefix& ano_colheita, size_t& p) const
     {
-        if (m == 0) return false;
-
-        p = search_key(ano_colheita, keys, m);
-    
-        while (p > 0 && Key::weak_comparator(keys[p], ano_colheita) == 0) p--;
-        if (Key::weak_comparator(keys[p], ano_colheita) < 0) p++;
-        return (p < m && Key::weak_comparator(keys[p], ano_colheita) == 0);
+        const auto& n = self();
+        p = n.lanes.count_less(ano_colheita, n.m);
+        return (p < n.m && Key::weak_comparator(n.keys[p], ano_colheita) == 0);
     }
 
     // Atribui ao parâmetro de referência p a posição da primeira chave com campo de busca superior a ano_colheita, caso exista.
-    // Retorna verdadeiro sse há alguma chave que satisfaça tal propriedade na folha.   
-    bool get_pos_next(const size_t& ano_colheita, size_t& p)
+    // Retorna verdadeiro sse há alguma chave que satisfaça tal propriedade na folha.
+    bool get_pos_next(const KeyPrefix& ano_colheita, size_t& p) const
     {
+        const auto& n = self();
         // Caso a folha esteja vazia ou a última chave (máxima, pois estão ordenadas)
         // seja menor ou igual a ano_colheita, então nenhuma chave na folha satisfaz a propriedade.
         // Portanto, a posição da próxima chave é m (após a última) nesse caso.
-        if (m == 0 || Key::weak_comparator(keys[m-1], ano_colheita) <= 0)
+        if (n.m == 0 || Key::weak_comparator(n.keys[n.m-1], ano_colheita) <= 0)
         {
-            p = m;
+            p = n.m;
             return false;
         }
 
-        p = search_key(ano_colheita, keys, m);
-        // Como aqui há pelo menos uma chave maior que ano colheita, não há necessidade de verificar se p < m. 
-        while (Key::weak_comparator(keys[p], ano_colheita) <= 0) p++;
+        p = n.lanes.count_less_equal(ano_colheita, n.m);
         return true;
     }
 
@@ -89,13 +56,18 @@ struct LeafNode
     // no nó apropriado (de modo que a parte direita tenha chaves estritamente maiores)
     // e o nó direito gerado é armazenado num parâmetro de referência.
     // Retorna verdadeiro sse a chave foi inserida e não houve particionamento.
-    // Em particular, quando a chave já está na folha (e não é inserida), o atributo m (número de chaves)
-    // do nó de overflow recebe 0, para distinguir-se do caso em que houve particionamento.
-    bool insert(const Key& k, LeafNode<NK>& overflow_sibling)
+    // Em particular, quando a chave já está na folha (e não é inserida), sua contagem de tuplas é acrescida
+    // da contagem de k e o atributo m (número de chaves) do nó de overflow recebe 0,
+    // para distinguir-se do caso em que houve particionamento.
+    bool insert(const Key& k, N& overflow_sibling)
     {
+        auto& m = self().m;
+        auto& keys = self().keys;
+
         auto p = find_pos(k);
         if (p < m && keys[p] == k)
         {
+            keys[p].count += k.count;
             overflow_sibling.m = 0;
             return false;
         }
@@ -106,7 +78,7 @@ struct LeafNode
 
             //supõe-se m > 0
             if (k < keys[m-1]) insert(k, overflow_sibling);
-            else overflow_sibling.insert(k, *this);
+            else static_cast<LeafNode&>(overflow_sibling).insert(k, self());
 
             return false;
         }
@@ -122,17 +94,21 @@ struct LeafNode
 
         keys[p] = k;
         m++;
+        self().lanes.assign(keys, m);
 
         return true;
     }
 
     // Particiona nó ao meio, coloca metade direita em <sibling>.
-    void split(LeafNode<NK>& sibling)
+    void split(N& sibling)
     {
-        m /= 2;
+        auto& n = self();
+        n.m /= 2;
 
-        sibling.m = NK - m;
-        std::copy(keys.begin() + m, keys.end(), sibling.keys.begin());
+        sibling.m = NK - n.m;
+        std::copy(n.keys.begin() + n.m, n.keys.end(), sibling.keys.begin());
+        n.lanes.assign(n.keys, n.m);
+        sibling.lanes.assign(sibling.keys, sibling.m);
     }
 
 private:
@@ -141,18 +117,20 @@ private:
     // pode acarretar underflow (quando p == 0).
     void _remove(const size_t& p)
     {
-        m--;
-        for (int i = p; i < m; i++)
+        auto& n = self();
+        n.m--;
+        for (int i = p; i < n.m; i++)
         {
-            keys[i] = keys[i+1];
+            n.keys[i] = n.keys[i+1];
         }
+        n.lanes.assign(n.keys, n.m);
     }
 
 public:
     // Remove chave na posição p atestando previamente a validade do índice.
     void remove(const size_t& p)
     {
-        if (m == 0) return;
+        if (self().m == 0) return;
         _remove(p);
     }
 
@@ -161,7 +139,7 @@ public:
     bool remove(const Key& k)
     {
         auto p = find_pos(k);
-        if (m == 0 || keys[p] != k) return false;
+        if (self().m == 0 || self().keys[p] != k) return false;
         _remove(p);
         return true;
     }
@@ -171,20 +149,23 @@ private:
     // Não verifica validade dos parâmetros, pois é de uso interno apenas.
     void _remove_weak(const size_t& first, const size_t& removed)
     {
-        m -= removed;
+        auto& n = self();
+        n.m -= removed;
 
-        for (int i = first; i < m; i++)
+        for (int i = first; i < n.m; i++)
         {
-            keys[i] = keys[i + removed];
+            n.keys[i] = n.keys[i + removed];
         }
+        n.lanes.assign(n.keys, n.m);
     }
 
 public:
     // Remove as chaves entre os índices first e last (exclusive).
     // Garante que esses índices estejam dentro da sequência de chaves.
-    void remove_weak(const size_t& first, const size_t& last)
+    void remove_weak(size_t first, size_t last)
     {
         if (first >= last) return;
+        const auto& m = self().m;
         first = m < first? m: first;
         last = m < last? m: last;
 
@@ -195,32 +176,19 @@ public:
 
     // Remove todas as chaves iguais a ano_colheita.
     // Retorna o número de chaves removidas.
-    size_t remove_weak(const size_t& ano_colheita)
+    size_t remove_weak(const KeyPrefix& ano_colheita)
     {
+        const auto& n = self();
         size_t first;
         get_pos_weak(ano_colheita, first);
-        if (m == 0 || Key::weak_comparator(keys[first], ano_colheita) != 0) return 0;
+        if (n.m == 0 || Key::weak_comparator(n.keys[first], ano_colheita) != 0) return 0;
         size_t last = first + 1;
-        while (last < m && Key::weak_comparator(keys[last], ano_colheita) == 0) last++;
+        while (last < n.m && Key::weak_comparator(n.keys[last], ano_colheita) == 0) last++;
 
         size_t removed = last - first;
         _remove_weak(first, removed);
         return removed;
     }
-
-    // Escreve campos do nó formatados em fluxo de saída.
-    template <typename OS>
-    friend OS& operator << (OS& os, const LeafNode<NK>& node)
-    {
-        os << node.l << ' ' << node.r << ' ' << node.m << ' ';
-        int i;
-        for (i = 0; i < node.m; i++)
-        {
-            os << node.keys[i] << ' ';
-        }
-
-        return os;
-    }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -4,6 +4,8 @@
 #include <cstdio>
 #include <array>
 #include <vector>
+#include <string>
+#include <cstdlib>
 #include "key.hpp"
 
 // Define funções utilitárias banais.
@@ -26,23 +28,32 @@ size_t binary_search(const T& key, const std::array<T, size>& seq, const size_t&
     return i;
 }
 
-// Pesquisa por chave apenas por ano de colheita, ignorando a chave primária.
-// Não necessariamente retorna índice da primeira ocorrência.
-template <size_t size>
-size_t search_key(const size_t& ano_colheita, const std::array<Key, size>& keys, const size_t& n = size)
+// Compara dois valores de campo: numericamente, caso ambos sejam números,
+// e lexicograficamente caso contrário (números antecedem os demais valores).
+// Retorna um inteiro negativo, nulo ou positivo, como std::string::compare.
+inline int compare_values(const std::string& a, const std::string& b)
 {
-    size_t i = 0, j = n - 1, c;
+    char *end_a, *end_b;
+    double x = std::strtod(a.c_str(), &end_a), y = std::strtod(b.c_str(), &end_b);
+    bool numeric_a = !a.empty() && *end_a == '\0', numeric_b = !b.empty() && *end_b == '\0';
 
-    while (i < j)
+    if (numeric_a && numeric_b)
     {
-        c = (i+j)/2;
-        auto comp = Key::weak_comparator(keys[c], ano_colheita);
-        if (comp == 0) return c;
-        if (comp < 0) i = c+1;
-        else j = c;
+        if (x < y) return -1;
+        if (x > y) return 1;
+        return a.compare(b);    // mesma magnitude mas grafias distintas (ex.: "1" e "1.0")
     }
-
-    return i;
+    if (numeric_a != numeric_b) return numeric_a? -1: 1;
+    return a.compare(b);
 }
 
+// Comparador "menor que" correspondente, para uso em contêineres e algoritmos ordenados.
+struct ValueLess
+{
+    inline bool operator () (const std::string& a, const std::string& b) const
+    {
+        return compare_values(a, b) < 0;
+    }
+};
+
 #endif
\ No newline at end of file
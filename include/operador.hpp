@@ -4,6 +4,11 @@
 #include "b_plus_tree.hpp"
 #include "csv.hpp"
 #include "stats.hpp"
+#include "instrumentation.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
 
 template <size_t N>
 class Operador
@@ -11,45 +16,72 @@ class Operador
 private:
     Tabela& table;
     const std::string keys[N], values[N];
-    size_t matching_index;
+    std::shared_ptr<BPlusTree> matching_tree;
+    size_t threads;
     Stats stats;
+    Instrumentation instrumentation;
 public:
-    Operador(Tabela& table, const std::string (&keys)[N], const std::string (&values)[N])
-        : table(table), keys(keys), values(values), stats(0, 0, 0)
+    // Escolhe o índice, simples ou composto, cujo prefixo restringido pelos predicados seja o mais seletivo,
+    // isto é, o que possua mais valores distintos estimados para esse prefixo.
+    // Com <threads> maior que 1, prefixos frequentes, cujas folhas ocupam várias subárvores,
+    // são selecionados em paralelo (ver BPlusTree::select); por padrão, a seleção é sequencial.
+    Operador(Tabela& table, const std::string (&keys)[N], const std::string (&values)[N], const size_t& threads = 1)
+        : table(table), keys(keys), values(values), threads(threads), stats(0, 0, 0)
     { 
-        matching_index = 0;
-        size_t best_unique = table.indices[keys[0]]->unique_keys;
+        size_t best_distinct = 0;
 
-        for (size_t i = 1; i < N; i++)
+        for (const auto& [name, tree]: table.indices)
         {
-            size_t cur_unique = table.indices[keys[i]]->unique_keys;
-            if (cur_unique > best_unique) 
+            size_t cur_distinct = tree->estimated_distinct(tree->prefix_length(keys));
+            if (cur_distinct > best_distinct)
             {
-                matching_index = i;
-                best_unique = cur_unique; 
+                matching_tree = tree;
+                best_distinct = cur_distinct;
             }
         }
     }
 
     void executar()
     {
-        stats = table.indices[keys[matching_index]]->select(matching_index, keys, values);
+        if (!matching_tree) throw std::logic_error("nenhum índice utilizável para as colunas " + csv(keys));
+        instrumentation.reset();
+        InstrumentationScope scope(instrumentation);
+        stats = matching_tree->select(keys, values, threads);
+    }
+
+    // Seleção sob demanda (ver BPlusTree::stream): as tuplas selecionadas são produzidas à medida que o consumidor
+    // avança, sem gravar resultado algum, e parar a iteração cedo (ex.: limit) evita a leitura das páginas restantes.
+    // As estatísticas são zeradas ao iniciar a iteração e acumuladas durante ela (exceto numPagsGeradas, sempre 0).
+    // O operador deve sobreviver ao gerador.
+    Generator<Tuple> tuplas()
+    {
+        if (!matching_tree) throw std::logic_error("nenhum índice utilizável para as colunas " + csv(keys));
+        stats = Stats(0, 0, 0);
+        for (const auto& tuple: matching_tree->stream({keys, keys + N}, {values, values + N}, stats))
+        {
+            stats.tuples++;
+            co_yield tuple;
+        }
     }
 
     void salvarTuplasGeradas(const std::string& path)
     {
-        auto& matching_key = keys[matching_index];
-        BPlusTree& matching_tree = *(table.indices[matching_key]);
         std::fstream out(path, std::ios::in | std::ios::out | std::ios::trunc);
+        salvarTuplasGeradas(out);
+    }
+
+    // Escreve as tuplas geradas, em csv com cabeçalho, no fluxo especificado.
+    void salvarTuplasGeradas(std::ostream& out)
+    {
         out << csv(table.scheme) << '\n';
-        PageSystem result_page(matching_tree.search_dir(keys, values), table.newTuple);
+        PageSystem result_page(matching_tree->search_dir(keys, values), table.newTuple);
         result_page.copy_to(out);
         const auto& occ = result_page.occupancy;
         if (occ > 0)
         {
             stats.ios += occ;
             result_page.append();
-            stats.tuples += (occ - 1)*PAGE_SIZE + result_page.buffer_page.occupancy;
+            stats.tuples += (occ - 1)*result_page.capacity() + result_page.buffer_page.occupancy;
         }
     }
 
@@ -67,6 +99,124 @@ public:
     {
         return stats.tuples;
     }
+
+    // Retorna a quantidade de páginas candidatas descartadas pelos filtros de Bloom, sem leitura
+    inline size_t numPagsEvitadas()
+    {
+        return stats.skipped;
+    }
+
+    // Descreve o plano da seleção: predicados, índices candidatos (com chaves únicas, valores distintos
+    // estimados e custo estimado em I/Os), o caminho de acesso escolhido e os predicados verificados
+    // no filtro de cada página. Com <analisar>, executa o plano e anota cada etapa com as linhas,
+    // páginas, I/Os e tempos efetivamente observados; sem índice utilizável, não há o que executar.
+    std::string explicar(const bool& analisar = false)
+    {
+        if (analisar && matching_tree) executar();
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1);
+        auto predicates = [&](const std::vector<size_t>& which)
+        {
+            std::stringstream out;
+            for (size_t i = 0; i < which.size(); i++)
+                out << (i == 0? "": " AND ") << keys[which[i]] << " = " << values[which[i]];
+            return which.empty()? std::string("nenhum"): out.str();
+        };
+        auto timing = [&](const Phase& phase)
+        {
+            std::stringstream out;
+            out << std::fixed << std::setprecision(3) << instrumentation.wall_ns[(size_t) phase] / 1e6 << " ms";
+            return out.str();
+        };
+
+        std::vector<size_t> all(N);
+        for (size_t i = 0; i < N; i++) all[i] = i;
+
+        size_t table_pages = table.get_page().occupancy;
+        ss << (analisar? "EXPLAIN ANALYZE": "EXPLAIN") << '\n';
+        ss << "Seleção em " << table.name << " (" << table_pages << " páginas)\n";
+        ss << "  Predicados: " << predicates(all) << '\n';
+        ss << "  Índices candidatos:\n";
+        for (const auto& [name, tree]: table.indices)
+        {
+            size_t n = tree->prefix_length(keys);
+            ss << "    " << (tree == matching_tree? "* ": "  ") << name << ": ";
+            if (n == 0)
+            {
+                ss << "inutilizável (coluna " << tree->columns[0] << " não restringida)\n";
+                continue;
+            }
+            ss << "prefixo " << n << "/" << tree->columns.size() << ", chaves únicas " << tree->unique_keys
+               << ", distintos estimados " << tree->estimated_distinct(n)
+               << ", custo estimado " << tree->estimated_cost(n, table_pages) << " I/Os\n";
+        }
+
+        if (!matching_tree)
+        {
+            ss << "  Acesso: nenhum índice utilizável\n";
+            return ss.str();
+        }
+
+        // Predicados sobre o prefixo do índice formam a chave de busca; os demais são verificados em cada tupla.
+        std::vector<size_t> pushed, residual;
+        size_t n = matching_tree->prefix_length(keys);
+        for (size_t i = 0; i < N; i++)
+        {
+            auto pos = std::find(matching_tree->columns.begin(), matching_tree->columns.begin() + n, keys[i]);
+            (pos != matching_tree->columns.begin() + n? pushed: residual).push_back(i);
+        }
+        std::vector<std::string> bloom;
+        for (const auto& key: keys)
+        {
+            if (table.bloom_filters.count(key)) bloom.push_back(key);
+        }
+
+        size_t depth = matching_tree->get_depth();
+        ss << "  Acesso: índice " << csv(matching_tree->columns) << '\n';
+        ss << "    -> Descida (profundidade " << depth << "), chave: " << predicates(pushed);
+        if (analisar)
+        {
+            ss << "  [real: nós por nível";
+            for (size_t level = 0; level <= depth && level < Instrumentation::MAX_LEVELS; level++)
+                ss << " " << instrumentation.nodes_per_level[level];
+            ss << ", " << timing(Phase::DESCENT) << "]";
+        }
+        ss << '\n';
+        ss << "    -> Percurso das folhas";
+        if (analisar)
+        {
+            size_t leaves = depth < Instrumentation::MAX_LEVELS? (size_t) instrumentation.nodes_per_level[depth]: 0;
+            ss << "  [real: folhas visitadas " << leaves << ", " << timing(Phase::LEAF_WALK) << "]";
+        }
+        ss << '\n';
+        ss << "    -> Leitura das páginas apontadas, filtros de Bloom: " << (bloom.empty()? std::string("nenhum"): csv(bloom));
+        if (analisar)
+        {
+            ss << "  [real: páginas lidas " << instrumentation.page_hits + instrumentation.page_misses
+               << " (do cache " << instrumentation.page_hits << "), evitadas " << stats.skipped
+               << ", tuplas decodificadas " << instrumentation.rows_decoded << ", " << timing(Phase::PAGE_FETCH) << "]";
+        }
+        ss << '\n';
+        ss << "    -> Filtro: " << predicates(residual);
+        if (analisar) ss << "  [real: tuplas " << stats.tuples << ", " << timing(Phase::FILTER) << "]";
+        ss << '\n';
+        ss << "    -> Materialização";
+        if (analisar)
+        {
+            ss << "  [real: páginas geradas " << stats.pags << ", I/Os " << stats.ios
+               << ", bytes lidos " << instrumentation.bytes_read << ", bytes gravados " << instrumentation.bytes_written
+               << ", " << timing(Phase::MATERIALIZE) << "]";
+        }
+        ss << '\n';
+        return ss.str();
+    }
+
+    // Instrumentação detalhada da última execução (tempos por fase, bytes, caches e nós por nível).
+    inline const Instrumentation& instrumentacao() const
+    {
+        return instrumentation;
+    }
 };
 
 #endif // OPERADOR_HPP
\ No newline at end of file
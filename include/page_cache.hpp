@@ -0,0 +1,151 @@
+#ifndef PAGE_CACHE_HPP
+#define PAGE_CACHE_HPP
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+
+#include "consts.hpp"
+#include "async_io.hpp"
+
+// Bloco de memória alinhado a PAGE_SLOT_SIZE, com tamanho múltiplo dele, como exigem as leituras e escritas com O_DIRECT.
+struct FrameDeleter { void operator()(char* p) const { std::free(p); } };
+using Frame = std::unique_ptr<char, FrameDeleter>;
+
+inline size_t align_up(const size_t& bytes) { return (bytes + PAGE_SLOT_SIZE - 1) / PAGE_SLOT_SIZE * PAGE_SLOT_SIZE; }
+
+inline Frame aligned_frame(const size_t& bytes)
+{
+    return Frame(static_cast<char*>(std::aligned_alloc(PAGE_SLOT_SIZE, align_up(bytes? bytes: 1))));
+}
+
+// Abre o arquivo com O_DIRECT; se o sistema de arquivos não o suportar, abre-o normalmente.
+inline int open_direct(const std::string& path, const int& flags, const mode_t& mode = 0644)
+{
+    int fd = open(path.c_str(), flags | O_DIRECT, mode);
+    if (fd < 0 && errno == EINVAL) fd = open(path.c_str(), flags, mode);
+    return fd;
+}
+
+// Lê <n> bytes a partir de <pos> de um descritor aberto com O_DIRECT, por meio de um bloco alinhado
+// que cobre o intervalo; posição e tamanho não precisam ser alinhados. Retorna os bytes copiados ou -errno.
+inline long read_direct(const int& fd, const size_t& pos, char* out, const size_t& n)
+{
+    size_t first = pos / PAGE_SLOT_SIZE * PAGE_SLOT_SIZE, length = align_up(pos + n) - first;
+    auto frame = aligned_frame(length);
+    long read = AsyncIO::read(fd, first, frame.get(), length);
+    if (read < 0) return read;
+    long available = read - (long) (pos - first);
+    if (available <= 0) return 0;
+    size_t copied = std::min((size_t) available, n);
+    std::memcpy(out, frame.get() + (pos - first), copied);
+    return copied;
+}
+
+// Cache de aplicação (LRU) para o modo de E/S direta, no qual o cache de páginas do núcleo é contornado:
+// guarda blocos de arquivos (slots de páginas de dados e registros de nós), identificados pelo caminho e posição,
+// até PAGE_CACHE_BYTES no total. Compartilhado por todas as tabelas do processo e protegido por mutex.
+// As escritas do modo direto o atualizam (write-through); arquivos recriados ou relocados devem ser invalidados.
+class PageCache
+{
+private:
+    struct Entry
+    {
+        std::string file;
+        size_t offset, size;
+        Frame frame;
+    };
+    using Position = std::list<Entry>::iterator;
+
+    std::list<Entry> lru;   // mais recente à frente
+    std::unordered_map<std::string, std::unordered_map<size_t, Position>> files;
+    size_t capacity, used;
+    std::mutex mutex;
+
+    void erase(const Position& entry)
+    {
+        used -= entry->size;
+        auto file = files.find(entry->file);
+        file->second.erase(entry->offset);
+        if (file->second.empty()) files.erase(file);
+        lru.erase(entry);
+    }
+
+public:
+    explicit PageCache(const size_t& capacity = PAGE_CACHE_BYTES): capacity(capacity), used(0) {}
+
+    static PageCache& shared()
+    {
+        static PageCache cache;
+        return cache;
+    }
+
+    // Copia para <out> os <n> primeiros bytes do bloco em cache, se houver. Retorna verdadeiro sse houve acerto.
+    bool get(const std::string& file, const size_t& offset, char* out, const size_t& n)
+    {
+        std::lock_guard lock(mutex);
+        auto entries = files.find(file);
+        if (entries == files.end()) return false;
+        auto entry = entries->second.find(offset);
+        if (entry == entries->second.end() || entry->second->size < n) return false;
+        lru.splice(lru.begin(), lru, entry->second);
+        std::memcpy(out, entry->second->frame.get(), n);
+        return true;
+    }
+
+    // Guarda (ou substitui) o bloco de <size> bytes, descartando os menos recentes se preciso.
+    void put(const std::string& file, const size_t& offset, Frame frame, const size_t& size)
+    {
+        std::lock_guard lock(mutex);
+        auto& entries = files[file];
+        auto existing = entries.find(offset);
+        if (existing != entries.end()) erase(existing->second);
+
+        lru.push_front(Entry{file, offset, size, std::move(frame)});
+        files[file][offset] = lru.begin();
+        used += size;
+        while (used > capacity && lru.size() > 1) erase(std::prev(lru.end()));
+    }
+
+    // Guarda uma cópia de <size> bytes de <data>.
+    void put(const std::string& file, const size_t& offset, const char* data, const size_t& size)
+    {
+        auto frame = aligned_frame(size);
+        std::memcpy(frame.get(), data, size);
+        put(file, offset, std::move(frame), size);
+    }
+
+    // Descarta os blocos de todos os arquivos cujo caminho começa com <prefix> (um arquivo ou um diretório).
+    void invalidate(const std::string& prefix)
+    {
+        std::lock_guard lock(mutex);
+        for (auto file = files.begin(); file != files.end(); )
+        {
+            if (file->first.compare(0, prefix.size(), prefix) != 0)
+            {
+                file++;
+                continue;
+            }
+            for (auto& [offset, entry]: file->second)
+            {
+                used -= entry->size;
+                lru.erase(entry);
+            }
+            file = files.erase(file);
+        }
+    }
+
+    // Bytes atualmente em cache.
+    size_t size()
+    {
+        std::lock_guard lock(mutex);
+        return used;
+    }
+};
+
+#endif // PAGE_CACHE_HPP
@@ -0,0 +1,123 @@
+#ifndef PROJECAO_HPP
+#define PROJECAO_HPP
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "tabela.hpp"
+#include "csv.hpp"
+#include "stats.hpp"
+
+// Projeção: SELECT col_1, col_2, ..., col_n FROM tabela
+// O conjunto de colunas requisitadas é repassado à decodificação das páginas,
+// de modo que os demais campos de cada tupla nunca sejam interpretados nem copiados.
+template <size_t N>
+class Projecao
+{
+private:
+    Tabela& table;
+    const std::vector<std::string> columns;     // colunas projetadas, na ordem requisitada
+    std::vector<size_t> positions;              // posições dessas colunas no esquema da tabela, em ordem crescente
+    Stats stats;
+
+    std::string result_directory()
+    {
+        return table.result_directory + "proj:" + csv(columns) + "/";
+    }
+
+public:
+    Projecao(Tabela& table, const std::string (&columns)[N])
+        : table(table), columns(columns, columns + N), stats(0, 0, 0)
+    {
+        for (const auto& column: this->columns)
+        {
+            auto pos = std::find(table.scheme.begin(), table.scheme.end(), column);
+            if (pos == table.scheme.end()) throw std::out_of_range("coluna inexistente: " + column);
+            positions.push_back(pos - table.scheme.begin());
+        }
+        std::sort(positions.begin(), positions.end());
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    }
+
+    void executar()
+    {
+        stats = Stats(0, 0, 0);
+        std::filesystem::remove_all(result_directory());
+        TablePageSystem result_page(result_directory(), table.newTuple);
+        TablePageSystem table_page = table.get_page();
+
+        for (size_t page = 0; page < table_page.occupancy; page++)
+        {
+            table_page.load_page(page);
+            stats.ios++;
+            table_page.load_tuples(positions);
+
+            for (size_t i = 0; i < table_page.buffer_page.occupancy; i++)
+            {
+                std::stringstream row;
+                table_page[i].write(row, columns);
+                result_page << row.str();
+                stats.tuples++;
+            }
+        }
+
+        stats.pags = result_page.occupancy;
+        result_page.update_header();
+        result_page.save_page();
+    }
+
+    // Projeção sob demanda, sem gravar resultado: produz tuplas com apenas as colunas projetadas (cujo esquema é
+    // a lista de colunas requisitadas), lendo cada página apenas quando o consumidor chega a ela. As estatísticas
+    // são zeradas ao iniciar a iteração e acumuladas durante ela. A projeção deve sobreviver ao gerador.
+    Generator<Tuple> tuplas()
+    {
+        stats = Stats(0, 0, 0);
+        TablePageSystem table_page = table.get_page();
+        Tuple projected(columns);
+        for (size_t page = 0; page < table_page.occupancy; page++)
+        {
+            table_page.load_page(page);
+            stats.ios++;
+            table_page.load_tuples(positions);
+
+            for (size_t i = 0; i < table_page.buffer_page.occupancy; i++)
+            {
+                for (const auto& column: columns) projected.fields[column] = table_page[i][column];
+                stats.tuples++;
+                co_yield projected;
+            }
+        }
+    }
+
+    void salvarTuplasGeradas(const std::string& path)
+    {
+        std::fstream out(path, std::ios::in | std::ios::out | std::ios::trunc);
+        salvarTuplasGeradas(out);
+    }
+
+    // Escreve as tuplas geradas, em csv com cabeçalho, no fluxo especificado.
+    void salvarTuplasGeradas(std::ostream& out)
+    {
+        out << csv(columns) << '\n';
+        TablePageSystem result_page(result_directory(), table.newTuple);
+        result_page.copy_to(out);
+        stats.ios += result_page.occupancy;
+    }
+
+    inline size_t numPagsGeradas()
+    {
+        return stats.pags;
+    }
+
+    inline size_t numIOExecutados()
+    {
+        return stats.ios;
+    }
+
+    inline size_t numTuplasGeradas()
+    {
+        return stats.tuples;
+    }
+};
+
+#endif // PROJECAO_HPP
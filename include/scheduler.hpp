@@ -0,0 +1,431 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <vector>
+#include <deque>
+#include <array>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <utility>
+#include <stdexcept>
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include "instrumentation.hpp"
+
+// Prioridade das tarefas: entre as tarefas prontas, as de maior prioridade são executadas antes,
+// tanto na fila da própria thread quanto no roubo de tarefas das demais.
+enum class Priority { HIGH, NORMAL, LOW };
+
+class TaskGroup;
+
+// Escalonador de tarefas com roubo de trabalho (work stealing), compartilhado por todos os operadores do processo
+// (ver shared), de modo que operadores paralelos simultâneos dividam um único conjunto de threads em vez de
+// criar cada um as suas. Cada thread trabalhadora possui uma fila dupla por prioridade: as tarefas submetidas
+// por ela são empilhadas e desempilhadas no fim da sua fila (LIFO, aproveitando a cache), enquanto as threads
+// ociosas roubam do início das filas das demais (FIFO, as tarefas mais antigas e, em geral, maiores).
+// Tarefas submetidas de fora do escalonador são distribuídas entre as filas em rodízio.
+// As tarefas são agrupadas em TaskGroups, que permitem aguardar sua conclusão e encadear continuações.
+// Cada tarefa é executada com a instrumentação corrente e a prioridade de quem a submeteu (ver PriorityScope).
+class Scheduler
+{
+public:
+    // Métricas acumuladas desde a criação (ou o último reset) do escalonador.
+    struct Metrics
+    {
+        std::atomic<uint64_t> submitted {0}, executed {0}, stolen {0};
+        std::atomic<uint64_t> busy_ns {0};          // tempo executando tarefas, somado entre as threads
+        std::atomic<uint64_t> queue_ns {0};         // tempo entre a submissão e o início das tarefas, somado
+        std::atomic<uint64_t> overhead_ns {0};      // tempo gasto pelas threads procurando tarefas (filas e roubo)
+        std::atomic<uint64_t> helped {0};           // tarefas executadas por threads aguardando um TaskGroup
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Task
+    {
+        std::function<void()> run;
+        TaskGroup* group;
+        Priority priority;
+        Instrumentation* instrumentation;
+        Clock::time_point submitted;
+    };
+
+    static constexpr size_t NUM_PRIORITIES = 3;
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::array<std::deque<Task>, NUM_PRIORITIES> queues;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::mutex sleep_mutex;
+    std::condition_variable signal;     // sinalizado a cada submissão e a cada grupo concluído
+    size_t queued;                      // tarefas nas filas (protegido por sleep_mutex)
+    bool stop;
+    std::atomic<size_t> next_queue;     // rodízio das submissões externas
+    Clock::time_point start;
+    Metrics metrics;
+
+    // Escalonador e índice da thread trabalhadora corrente (nulo fora das threads trabalhadoras).
+    struct CurrentWorker
+    {
+        const Scheduler* scheduler = nullptr;
+        size_t index = 0;
+    };
+
+    static CurrentWorker& current_worker()
+    {
+        thread_local CurrentWorker worker;
+        return worker;
+    }
+
+    // Índice da thread corrente neste escalonador, ou workers.size() se ela não for uma de suas trabalhadoras.
+    size_t self() const
+    {
+        const auto& worker = current_worker();
+        return worker.scheduler == this? worker.index: workers.size();
+    }
+
+    static uint64_t elapsed_ns(const Clock::time_point& since)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+    }
+
+    // Retira uma tarefa pronta, de maior prioridade primeiro: do fim da fila da própria thread
+    // ou, na falta dela, do início da fila de outra thread. Retorna falso sse todas as filas estão vazias.
+    bool take(Task& out)
+    {
+        auto search = Clock::now();
+        size_t me = self(), n = workers.size();
+        for (size_t p = 0; p < NUM_PRIORITIES; p++)
+        {
+            if (me < n)
+            {
+                auto& worker = *workers[me];
+                std::lock_guard lock(worker.mutex);
+                auto& queue = worker.queues[p];
+                if (!queue.empty())
+                {
+                    out = std::move(queue.back());
+                    queue.pop_back();
+                    return dequeued(search, false);
+                }
+            }
+            for (size_t i = 1; i <= n; i++)
+            {
+                size_t victim = (me + i) % n;
+                if (victim == me) continue;
+                auto& worker = *workers[victim];
+                std::lock_guard lock(worker.mutex);
+                auto& queue = worker.queues[p];
+                if (!queue.empty())
+                {
+                    out = std::move(queue.front());
+                    queue.pop_front();
+                    return dequeued(search, me < n);
+                }
+            }
+        }
+        metrics.overhead_ns += elapsed_ns(search);
+        return false;
+    }
+
+    bool dequeued(const Clock::time_point& search, const bool& stolen)
+    {
+        {
+            std::lock_guard lock(sleep_mutex);
+            queued--;
+        }
+        if (stolen) metrics.stolen++;
+        metrics.overhead_ns += elapsed_ns(search);
+        return true;
+    }
+
+    inline void execute(Task& task);
+
+    void work(const size_t& index)
+    {
+        current_worker() = CurrentWorker{this, index};
+        while (true)
+        {
+            Task task;
+            if (take(task))
+            {
+                execute(task);
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex);
+            signal.wait(lock, [this](){ return stop || queued > 0; });
+            if (stop && queued == 0) return;
+        }
+    }
+
+    void submit(Task task)
+    {
+        {
+            std::lock_guard lock(sleep_mutex);
+            queued++;
+        }
+        size_t me = self();
+        size_t target = me < workers.size()? me: next_queue++ % workers.size();
+        {
+            auto& worker = *workers[target];
+            std::lock_guard lock(worker.mutex);
+            worker.queues[(size_t) task.priority].push_back(std::move(task));
+        }
+        metrics.submitted++;
+        signal.notify_all();
+    }
+
+    // Executa uma tarefa pronta, se houver, na thread corrente. Usado pelas threads que aguardam um TaskGroup.
+    bool help()
+    {
+        Task task;
+        if (!take(task)) return false;
+        metrics.helped++;
+        execute(task);
+        return true;
+    }
+
+    friend TaskGroup;
+
+public:
+    // Escalonador com <num_workers> threads trabalhadoras (por padrão, uma por núcleo disponível).
+    explicit Scheduler(size_t num_workers = std::thread::hardware_concurrency()):
+        queued(0), stop(false), next_queue(0), start(Clock::now())
+    {
+        if (num_workers == 0) num_workers = 1;
+        for (size_t i = 0; i < num_workers; i++) workers.push_back(std::make_unique<Worker>());
+        for (size_t i = 0; i < num_workers; i++) threads.emplace_back([this, i](){ work(i); });
+    }
+
+    Scheduler(const Scheduler&) = delete;
+
+    // Conclui as tarefas pendentes e encerra as threads.
+    ~Scheduler()
+    {
+        {
+            std::lock_guard lock(sleep_mutex);
+            stop = true;
+        }
+        signal.notify_all();
+        for (auto& thread: threads) thread.join();
+    }
+
+    // Quantidade de threads trabalhadoras do escalonador compartilhado, definida antes de seu primeiro uso.
+    // Zero (o padrão) corresponde a uma por núcleo disponível.
+    static size_t& default_workers()
+    {
+        static size_t workers = 0;
+        return workers;
+    }
+
+    // Define a quantidade de threads do escalonador compartilhado. Deve ser chamada antes de seu primeiro uso;
+    // caso contrário, lança logic_error.
+    static void configure(const size_t& workers)
+    {
+        if (created()) throw std::logic_error("o escalonador compartilhado já foi criado");
+        default_workers() = workers;
+    }
+
+    // Escalonador compartilhado pelos operadores, criado no primeiro uso.
+    static Scheduler& shared()
+    {
+        static Scheduler scheduler(default_workers()? default_workers(): std::thread::hardware_concurrency());
+        created() = true;
+        return scheduler;
+    }
+
+    // Prioridade corrente da thread: a das tarefas que ela submeter (ver PriorityScope).
+    static Priority& current_priority()
+    {
+        thread_local Priority priority = Priority::NORMAL;
+        return priority;
+    }
+
+    inline size_t size() const { return workers.size(); }
+
+    inline const Metrics& metricas() const { return metrics; }
+
+    void reset_metrics()
+    {
+        metrics.submitted = metrics.executed = metrics.stolen = metrics.helped = 0;
+        metrics.busy_ns = metrics.queue_ns = metrics.overhead_ns = 0;
+        start = Clock::now();
+    }
+
+    // Exporta as métricas como um objeto JSON: contagens de tarefas, latência média de fila,
+    // custo médio de escalonamento por tarefa e utilização (fração do tempo das threads ocupada com tarefas).
+    std::string json() const
+    {
+        double executed = std::max<uint64_t>(metrics.executed, 1);
+        double capacity = (double) elapsed_ns(start) * workers.size();
+        std::stringstream ss;
+        ss << "{\"workers\":" << workers.size() << ",\"submitted\":" << metrics.submitted
+           << ",\"executed\":" << metrics.executed << ",\"stolen\":" << metrics.stolen << ",\"helped\":" << metrics.helped
+           << ",\"avg_queue_us\":" << metrics.queue_ns / executed / 1e3
+           << ",\"avg_overhead_us\":" << metrics.overhead_ns / executed / 1e3
+           << ",\"utilization\":" << (capacity > 0? metrics.busy_ns / capacity: 0) << "}";
+        return ss.str();
+    }
+
+private:
+    static bool& created()
+    {
+        static bool created = false;
+        return created;
+    }
+};
+
+// Define a prioridade corrente da thread enquanto existir, restaurando a anterior ao ser destruído.
+// As tarefas submetidas nesse intervalo (e as que elas submeterem) herdam essa prioridade.
+class PriorityScope
+{
+private:
+    Priority previous;
+public:
+    PriorityScope(const Priority& priority): previous(Scheduler::current_priority())
+    {
+        Scheduler::current_priority() = priority;
+    }
+
+    ~PriorityScope() { Scheduler::current_priority() = previous; }
+};
+
+// Grupo de tarefas submetidas a um escalonador. wait bloqueia até a conclusão de todas elas, executando
+// tarefas prontas enquanto isso, de modo que tarefas possam aguardar subtarefas sem esgotar as threads.
+// A primeira exceção lançada por uma tarefa do grupo é relançada por wait.
+// Uma continuação (then) é submetida como tarefa assim que o grupo é concluído.
+//     TaskGroup group;
+//     for (const auto& part: parts) group.run([&](){ processar(part); });
+//     group.wait();
+class TaskGroup
+{
+private:
+    Scheduler& scheduler;
+    Priority priority;
+    size_t pending;     // tarefas submetidas e ainda não concluídas (protegido por scheduler.sleep_mutex)
+    std::mutex mutex;
+    std::exception_ptr error;
+    std::function<void()> continuation;
+
+    friend Scheduler;
+
+    void fail(std::exception_ptr e)
+    {
+        std::lock_guard lock(mutex);
+        if (!error) error = e;
+    }
+
+    // Conclui uma tarefa do grupo. O grupo pode ser destruído por quem o aguarda assim que a última é concluída,
+    // de modo que seus campos não são acessados após a liberação do mutex.
+    void finish()
+    {
+        Scheduler& owner = scheduler;
+        Priority next_priority = priority;
+        std::function<void()> next;
+        {
+            std::lock_guard lock(owner.sleep_mutex);
+            if (--pending == 0) next = std::move(continuation);
+        }
+        owner.signal.notify_all();
+        if (next) owner.submit({std::move(next), nullptr, next_priority, Instrumentation::current(), std::chrono::steady_clock::now()});
+    }
+
+public:
+    // Grupo com a prioridade corrente da thread, no escalonador compartilhado.
+    explicit TaskGroup(const Priority& priority = Scheduler::current_priority(), Scheduler& scheduler = Scheduler::shared()):
+        scheduler(scheduler), priority(priority), pending(0)
+    {}
+
+    TaskGroup(const TaskGroup&) = delete;
+
+    // As tarefas referenciam variáveis de quem as submeteu: o grupo sempre as aguarda antes de ser destruído.
+    ~TaskGroup()
+    {
+        try { wait(); } catch (...) {}
+    }
+
+    // Quantidade de threads do escalonador, isto é, o paralelismo útil do grupo.
+    inline size_t workers() const { return scheduler.size(); }
+
+    void run(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock(scheduler.sleep_mutex);
+            pending++;
+        }
+        scheduler.submit({std::move(task), this, priority, Instrumentation::current(), std::chrono::steady_clock::now()});
+    }
+
+    // Define a tarefa executada após a conclusão de todas as tarefas do grupo (ou imediatamente, se não houver
+    // nenhuma pendente). Ela não pertence ao grupo: wait não a aguarda.
+    void then(std::function<void()> next)
+    {
+        {
+            std::lock_guard lock(scheduler.sleep_mutex);
+            if (pending > 0)
+            {
+                continuation = std::move(next);
+                return;
+            }
+        }
+        scheduler.submit({std::move(next), nullptr, priority, Instrumentation::current(), std::chrono::steady_clock::now()});
+    }
+
+    void wait()
+    {
+        while (true)
+        {
+            {
+                std::lock_guard lock(scheduler.sleep_mutex);
+                if (pending == 0) break;
+            }
+            if (scheduler.help()) continue;
+            std::unique_lock lock(scheduler.sleep_mutex);
+            scheduler.signal.wait(lock, [this](){ return pending == 0 || scheduler.queued > 0; });
+        }
+        std::lock_guard lock(mutex);
+        if (error) std::rethrow_exception(std::exchange(error, nullptr));
+    }
+};
+
+// Executa a tarefa com a instrumentação e a prioridade de quem a submeteu. Para a utilização, conta-se apenas o tempo
+// das tarefas mais externas das threads trabalhadoras: as executadas enquanto uma tarefa aguarda seu grupo
+// já estão contidas no tempo dela, e as executadas por threads externas não ocupam o escalonador.
+inline void Scheduler::execute(Task& task)
+{
+    thread_local size_t depth = 0;
+    metrics.queue_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - task.submitted).count();
+    auto begin = Clock::now();
+    depth++;
+    {
+        auto previous = Instrumentation::current();
+        Instrumentation::current() = task.instrumentation;
+        PriorityScope priority(task.priority);
+        try
+        {
+            task.run();
+        }
+        catch (...)
+        {
+            if (task.group) task.group->fail(std::current_exception());
+        }
+        Instrumentation::current() = previous;
+    }
+    if (--depth == 0 && self() < workers.size()) metrics.busy_ns += elapsed_ns(begin);
+    metrics.executed++;
+    if (task.group) task.group->finish();
+}
+
+#endif // SCHEDULER_HPP
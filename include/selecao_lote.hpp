@@ -0,0 +1,122 @@
+#ifndef SELECAO_LOTE_HPP
+#define SELECAO_LOTE_HPP
+
+#include "b_plus_tree.hpp"
+#include "csv.hpp"
+#include "stats.hpp"
+#include "instrumentation.hpp"
+
+#include <array>
+#include <vector>
+#include <stdexcept>
+
+// Seleção em lote: várias consultas por igualdade sobre as mesmas colunas, executadas de uma só vez
+// (ver BPlusTree::select_batch). Em vez de uma descida, um percurso de folhas e uma leitura de páginas por consulta,
+// o índice é percorrido uma única vez em ordem de chave e cada página de dados é lida uma única vez para todas as
+// consultas que a referenciam. Cada consulta tem seu próprio resultado, identificado pela ordem de adição.
+//     SelecaoEmLote lote {vinho, {"ano_producao"}};
+//     auto q = lote.adicionar({"1990"});
+//     lote.executar();
+//     lote.salvarTuplasGeradas(q, "vinhos_1990.csv");
+template <size_t N>
+class SelecaoEmLote
+{
+private:
+    Tabela& table;
+    const std::string keys[N];
+    std::vector<std::array<std::string, N>> queries;
+    std::shared_ptr<BPlusTree> matching_tree;
+    std::vector<Stats> query_stats;
+    Stats stats;
+    Instrumentation instrumentation;
+public:
+    // Escolhe o índice como Operador: o de prefixo restringido pelas colunas mais seletivo.
+    SelecaoEmLote(Tabela& table, const std::string (&keys)[N])
+        : table(table), keys(keys), stats(0, 0, 0)
+    {
+        size_t best_distinct = 0;
+
+        for (const auto& [name, tree]: table.indices)
+        {
+            size_t cur_distinct = tree->estimated_distinct(tree->prefix_length(keys));
+            if (cur_distinct > best_distinct)
+            {
+                matching_tree = tree;
+                best_distinct = cur_distinct;
+            }
+        }
+    }
+
+    // Acrescenta ao lote a consulta com os valores especificados (na ordem das colunas).
+    // Retorna seu identificador, usado para consultar seus resultados após executar.
+    size_t adicionar(const std::array<std::string, N>& values)
+    {
+        queries.push_back(values);
+        return queries.size() - 1;
+    }
+
+    inline size_t numConsultas() const
+    {
+        return queries.size();
+    }
+
+    void executar()
+    {
+        if (!matching_tree) throw std::logic_error("nenhum índice utilizável para as colunas " + csv(keys));
+        instrumentation.reset();
+        InstrumentationScope scope(instrumentation);
+        stats = Stats(0, 0, 0);
+        query_stats = matching_tree->select_batch(keys, queries, stats);
+    }
+
+    void salvarTuplasGeradas(const size_t& consulta, const std::string& path)
+    {
+        std::string values[N];
+        std::copy(queries[consulta].begin(), queries[consulta].end(), values);
+        std::fstream out(path, std::ios::in | std::ios::out | std::ios::trunc);
+        out << csv(table.scheme) << '\n';
+        PageSystem result_page(matching_tree->search_dir(keys, values), table.newTuple);
+        result_page.copy_to(out);
+        stats.ios += result_page.occupancy;
+    }
+
+    // Totais do lote: páginas geradas, I/Os efetivamente executados (cada página lida uma única vez) e tuplas geradas.
+    inline size_t numPagsGeradas()
+    {
+        return stats.pags;
+    }
+
+    inline size_t numIOExecutados()
+    {
+        return stats.ios;
+    }
+
+    inline size_t numTuplasGeradas()
+    {
+        return stats.tuples;
+    }
+
+    // Estatísticas de uma consulta do lote; seus I/Os contam as páginas lidas para ela, ainda que compartilhadas.
+    inline size_t numPagsGeradas(const size_t& consulta)
+    {
+        return query_stats[consulta].pags;
+    }
+
+    inline size_t numIOExecutados(const size_t& consulta)
+    {
+        return query_stats[consulta].ios;
+    }
+
+    inline size_t numTuplasGeradas(const size_t& consulta)
+    {
+        return query_stats[consulta].tuples;
+    }
+
+    // Instrumentação detalhada da última execução do lote.
+    inline const Instrumentation& instrumentacao() const
+    {
+        return instrumentation;
+    }
+};
+
+#endif // SELECAO_LOTE_HPP
@@ -0,0 +1,350 @@
+#ifndef SERVIDOR_HPP
+#define SERVIDOR_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <sstream>
+#include <chrono>
+#include <stdexcept>
+#include <type_traits>
+#include <filesystem>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "tabela.hpp"
+#include "operador.hpp"
+#include "projecao.hpp"
+#include "juncao.hpp"
+#include "thread_pool.hpp"
+
+// Servidor de consultas local: carrega as tabelas (dados, índices e filtros) uma única vez e as mantém abertas,
+// com os dicionários de códigos e as raízes das árvores em memória e as páginas quentes no cache do sistema
+// ou, no modo de E/S direta, no PageCache. As requisições chegam por um socket de domínio Unix e cada conexão
+// é atendida por uma thread do ThreadPool, de modo que a latência de uma consulta cubra apenas a consulta.
+// Essas threads passam a maior parte do tempo bloqueadas no socket; o trabalho paralelo dos operadores
+// é executado pelo escalonador compartilhado (ver Scheduler), e não por elas.
+//
+// Protocolo (texto, uma requisição por linha; campos separados por um espaço, exceto nas listas, separadas por vírgula):
+//   SELECT <tabela> <coluna>=<valor>[,<coluna>=<valor>...]
+//   PROJECT <tabela> <coluna>[,<coluna>...]
+//   JOIN <tabela_1> <tabela_2> <coluna_1> <coluna_2>
+//   TABLES          lista as tabelas carregadas e seus esquemas
+//   QUIT            encerra a conexão
+//   SHUTDOWN        encerra o servidor após as conexões abertas
+// Resposta: "OK <linhas> <ios> <pags> <micros>" seguida de <linhas> linhas (para consultas, o csv do resultado
+// com cabeçalho), ou "ERR <mensagem>". Os valores podem conter espaços, mas não vírgulas.
+// Tabelas e colunas inexistentes e valores contendo "/" ou ".." são rejeitados, pois compõem os caminhos
+// dos diretórios de resultados. Requisições idênticas são serializadas, pois gravam no mesmo diretório de resultados.
+class Servidor
+{
+private:
+    std::string socket_path;
+    std::map<std::string, std::unique_ptr<Tabela>> tables;
+    size_t workers;
+    int listener;
+    std::atomic<bool> running;
+    // Trava de um texto de requisição e quantidade de threads que a detêm ou aguardam.
+    struct RequestLock
+    {
+        std::mutex mutex;
+        size_t holders = 0;
+    };
+
+    std::mutex locks_mutex;
+    std::map<std::string, RequestLock> request_locks;   // por texto de requisição, apenas enquanto houver detentores
+
+    static constexpr size_t MAX_COLUMNS = 8;    // colunas por seleção ou projeção (aridades instanciadas)
+
+    // Chama <run> com std::integral_constant<size_t, n>, instanciando os operadores para cada aridade até MAX_COLUMNS.
+    template <size_t N = 1, typename R>
+    static void com_aridade(const size_t& n, const R& run)
+    {
+        if (n == N) run(std::integral_constant<size_t, N>{});
+        else if constexpr (N < MAX_COLUMNS) com_aridade<N+1>(n, run);
+        else throw std::invalid_argument("quantidade de colunas não suportada: " + std::to_string(n));
+    }
+
+    static std::vector<std::string> split(const std::string& str, const char& sep, const size_t& max_parts = 0)
+    {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while (max_parts == 0 || parts.size() + 1 < max_parts)
+        {
+            size_t end = str.find(sep, start);
+            if (end == std::string::npos) break;
+            parts.push_back(str.substr(start, end - start));
+            start = end + 1;
+        }
+        parts.push_back(str.substr(start));
+        return parts;
+    }
+
+    Tabela& tabela(const std::string& name)
+    {
+        auto table = tables.find(name);
+        if (table == tables.end()) throw std::invalid_argument("tabela inexistente: " + name);
+        return *table->second;
+    }
+
+    // Serializa as requisições de mesmo texto enquanto existir; a entrada em request_locks
+    // é removida quando o último detentor a libera, de modo que o mapa não cresça indefinidamente.
+    class RequestGuard
+    {
+    private:
+        Servidor& server;
+        std::map<std::string, RequestLock>::iterator entry;
+        std::unique_lock<std::mutex> lock;
+
+    public:
+        RequestGuard(Servidor& server, const std::string& request): server(server)
+        {
+            {
+                std::lock_guard guard(server.locks_mutex);
+                entry = server.request_locks.try_emplace(request).first;
+                entry->second.holders++;
+            }
+            lock = std::unique_lock(entry->second.mutex);
+        }
+
+        ~RequestGuard()
+        {
+            lock.unlock();
+            std::lock_guard guard(server.locks_mutex);
+            if (--entry->second.holders == 0) server.request_locks.erase(entry);
+        }
+    };
+
+    // Verifica que a coluna pertence à tabela; caso contrário, a requisição é rejeitada.
+    static const std::string& coluna(const Tabela& table, const std::string& column)
+    {
+        if (std::find(table.scheme.begin(), table.scheme.end(), column) == table.scheme.end())
+            throw std::invalid_argument("coluna inexistente em " + table.name + ": " + column);
+        return column;
+    }
+
+    // Os valores dos predicados compõem os nomes dos diretórios de resultados (ver BPlusTree::search_dir):
+    // valores que poderiam alterar o caminho são rejeitados.
+    static const std::string& valor(const std::string& value)
+    {
+        if (value.find('/') != std::string::npos || value.find("..") != std::string::npos)
+            throw std::invalid_argument("valor inválido: " + value);
+        return value;
+    }
+
+    // Executa o operador, escreve seu resultado em <out> e preenche <stats> com as estatísticas da execução.
+    template <typename Op>
+    static void executar_operador(Op& op, std::ostream& out, Stats& stats)
+    {
+        op.executar();
+        stats = Stats(op.numPagsGeradas(), op.numIOExecutados(), op.numTuplasGeradas());
+        op.salvarTuplasGeradas(out);
+    }
+
+    void consultar(const std::vector<std::string>& fields, std::ostream& out, Stats& stats)
+    {
+        const auto& command = fields[0];
+        if (command == "SELECT" && fields.size() == 3)
+        {
+            std::vector<std::string> keys, values;
+            for (const auto& predicate: split(fields[2], ','))
+            {
+                auto parts = split(predicate, '=', 2);
+                if (parts.size() != 2) throw std::invalid_argument("predicado inválido: " + predicate);
+                keys.push_back(parts[0]);
+                values.push_back(parts[1]);
+            }
+            auto& table = tabela(fields[1]);
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                coluna(table, keys[i]);
+                valor(values[i]);
+            }
+            com_aridade(keys.size(), [&](auto arity)
+            {
+                constexpr size_t N = decltype(arity)::value;
+                std::string key_list[N], value_list[N];
+                std::copy(keys.begin(), keys.end(), key_list);
+                std::copy(values.begin(), values.end(), value_list);
+                Operador<N> op {table, key_list, value_list};
+                executar_operador(op, out, stats);
+            });
+        }
+        else if (command == "PROJECT" && fields.size() == 3)
+        {
+            auto columns = split(fields[2], ',');
+            auto& table = tabela(fields[1]);
+            for (const auto& column: columns) coluna(table, column);
+            com_aridade(columns.size(), [&](auto arity)
+            {
+                constexpr size_t N = decltype(arity)::value;
+                std::string column_list[N];
+                std::copy(columns.begin(), columns.end(), column_list);
+                Projecao<N> op {table, column_list};
+                executar_operador(op, out, stats);
+            });
+        }
+        else if (command == "JOIN" && fields.size() == 5)
+        {
+            auto &outer = tabela(fields[1]), &inner = tabela(fields[2]);
+            Juncao op {outer, inner, coluna(outer, fields[3]), coluna(inner, fields[4])};
+            executar_operador(op, out, stats);
+        }
+        else throw std::invalid_argument("requisição inválida: " + csv(fields));
+    }
+
+    // Responde a uma requisição. Atribui verdadeiro a <close> quando a conexão deve ser encerrada.
+    std::string responder(const std::string& request, bool& close)
+    {
+        auto command = split(request, ' ', 2)[0];
+        auto fields = split(request, ' ', command == "JOIN"? 5: 3);
+        if (command == "QUIT" || command == "SHUTDOWN")
+        {
+            close = true;
+            if (command == "SHUTDOWN") parar();
+            return "OK 0 0 0 0\n";
+        }
+        if (command == "TABLES")
+        {
+            std::stringstream body;
+            for (const auto& [name, table]: tables) body << name << ' ' << csv(table->scheme) << '\n';
+            return "OK " + std::to_string(tables.size()) + " 0 0 0\n" + body.str();
+        }
+
+        std::stringstream body;
+        Stats stats(0, 0, 0);
+        auto start = std::chrono::steady_clock::now();
+        {
+            RequestGuard guard(*this, request);
+            consultar(fields, body, stats);
+        }
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        auto text = body.str();
+        size_t lines = std::count(text.begin(), text.end(), '\n');
+        std::stringstream header;
+        header << "OK " << lines << ' ' << stats.ios << ' ' << stats.pags << ' ' << micros << '\n';
+        return header.str() + text;
+    }
+
+    static bool send_all(const int& fd, const std::string& data)
+    {
+        for (size_t sent = 0; sent < data.size(); )
+        {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    // Atende as requisições de uma conexão até que o cliente a encerre. Executada pelas threads do ThreadPool.
+    void atender(const int& client)
+    {
+        std::string pending;
+        char buffer[4096];
+        bool close = false;
+        while (!close)
+        {
+            size_t end;
+            while (!close && (end = pending.find('\n')) != std::string::npos)
+            {
+                std::string request = pending.substr(0, end);
+                pending.erase(0, end + 1);
+                if (!request.empty() && request.back() == '\r') request.pop_back();
+                if (request.empty()) continue;
+
+                std::string response;
+                try
+                {
+                    response = responder(request, close);
+                }
+                catch (const std::exception& e)
+                {
+                    response = std::string("ERR ") + e.what() + '\n';
+                }
+                if (!send_all(client, response)) close = true;
+            }
+            if (close) break;
+
+            ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            pending.append(buffer, n);
+        }
+        ::close(client);
+    }
+
+public:
+    // Servidor no socket especificado, com <workers> threads de atendimento (por padrão, uma por núcleo).
+    Servidor(const std::string& socket_path, const size_t& workers = std::thread::hardware_concurrency()):
+        socket_path(socket_path), workers(workers), listener(-1), running(false)
+    {}
+
+    ~Servidor()
+    {
+        if (listener >= 0) close(listener);
+    }
+
+    // Carrega a tabela do csv especificado, criando índices para todas as colunas; descarta dados de execuções anteriores.
+    // A tabela passa a ser identificada nas requisições pelo nome do arquivo, sem extensão.
+    Tabela& carregar(const std::string& path, const size_t& fanout = MAX_CHILDREN, const size_t& page_capacity = PAGE_SIZE,
+        const bool& direct_io = false)
+    {
+        std::string name = std::filesystem::path(path).stem();
+        std::filesystem::remove_all(GEN_DIR + name);
+        auto table = std::make_unique<Tabela>(path, fanout, page_capacity, direct_io);
+        table->carregarDados();
+        return *(tables[name] = std::move(table));
+    }
+
+    // Aceita conexões até que uma requisição SHUTDOWN seja atendida (ou o socket falhe),
+    // retornando após o encerramento das conexões abertas.
+    void executar()
+    {
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        if (socket_path.size() >= sizeof(address.sun_path)) throw std::invalid_argument("caminho de socket longo demais: " + socket_path);
+        std::copy(socket_path.begin(), socket_path.end(), address.sun_path);
+
+        unlink(socket_path.c_str());
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0 || bind(listener, (sockaddr*) &address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0)
+            throw std::runtime_error("não foi possível escutar em " + socket_path + ": " + std::strerror(errno));
+
+        running = true;
+        {
+            ThreadPool pool(workers);
+            while (running)
+            {
+                int client = accept(listener, nullptr, nullptr);
+                if (client < 0)
+                {
+                    if (errno == EINTR || errno == ECONNABORTED) continue;
+                    break;
+                }
+                pool.submit([this, client](){ atender(client); });
+            }
+        }
+        close(listener);
+        listener = -1;
+        unlink(socket_path.c_str());
+    }
+
+    // Deixa de aceitar conexões; as já abertas continuam sendo atendidas.
+    void parar()
+    {
+        running = false;
+        if (listener >= 0) shutdown(listener, SHUT_RDWR);
+    }
+};
+
+#endif // SERVIDOR_HPP
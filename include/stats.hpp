@@ -5,7 +5,8 @@
 
 struct Stats {
     size_t pags, ios, tuples;
-    Stats(size_t pags, size_t ios, size_t tuples): pags(pags), ios(ios), tuples(tuples) {}
+    size_t skipped;     // páginas cuja leitura foi evitada pelos filtros de Bloom
+    Stats(size_t pags, size_t ios, size_t tuples): pags(pags), ios(ios), tuples(tuples), skipped(0) {}
 };
 
 #endif
\ No newline at end of file
@@ -12,14 +12,30 @@
 #include <cstdio>
 #include <memory>
 #include <functional>
+#include <algorithm>
 
 // only for debugging:
 #include <iostream>
 
 #include "consts.hpp"
+#include "bloom.hpp"
+#include "zone_map.hpp"
+#include "instrumentation.hpp"
+#include "async_io.hpp"
+#include "page_cache.hpp"
+#include "generator.hpp"
+#include "stats.hpp"
 
 class BPlusTree;
+class Tabela;
 template <size_t N> class Operador;
+template <size_t N> class SelecaoEmLote;
+class Juncao;
+template <size_t N> class Projecao;
+class Contagem;
+class Agrupamento;
+class Varredura;
+class Servidor;
 
 void csv_parser(std::string entry, std::vector<std::string>& fields);
 
@@ -52,6 +68,44 @@ public:
         return *this;
     }
 
+    // Lê apenas os campos das posições especificadas (em ordem crescente) do esquema.
+    // Os demais campos não são copiados, e a linha deixa de ser percorrida após o último campo requisitado.
+    template <typename IS>
+    Tuple& load(IS& csv_file, const std::vector<size_t>& positions)
+    {
+        std::string cur_line;
+        std::getline(csv_file, cur_line);
+
+        size_t begin = 0, position = 0;
+        for (const auto& wanted: positions)
+        {
+            for (; position < wanted && begin != std::string::npos; position++)
+            {
+                begin = cur_line.find(',', begin);
+                if (begin != std::string::npos) begin++;
+            }
+            if (begin == std::string::npos) break;
+
+            size_t end = cur_line.find(',', begin);
+            fields[scheme[wanted]].assign(cur_line, begin, end == std::string::npos? std::string::npos: end - begin);
+        }
+
+        return *this;
+    }
+
+    // Escreve em csv apenas os campos especificados, na ordem especificada.
+    template <typename OS>
+    void write(OS& os, const std::vector<std::string>& field_names) const
+    {
+        bool first = true;
+        for (const auto& field_name: field_names)
+        {
+            if (first) first = false;
+            else os << ",";
+            os << (*this)[field_name];
+        }
+    }
+
     template <typename OS>
     friend OS& operator << (OS& os, const Tuple& tuple)
     {
@@ -97,10 +151,28 @@ private:
     friend BPlusTree;
     template <size_t N>
     friend class Operador;
+    template <size_t N>
+    friend class SelecaoEmLote;
+    friend Juncao;
+    template <size_t N>
+    friend class Projecao;
+    friend Contagem;
+    friend Agrupamento;
+    friend Varredura;
+    friend Tabela;
+
+    Page(const std::function<T()>& constructor = [](){ return T(); }, const size_t& capacity = PAGE_SIZE)
+        : tuples(capacity, constructor()), occupancy(0) {update_header();}
 
-    Page(const std::function<T()>& constructor = [](){ return T(); }): tuples(PAGE_SIZE, constructor()), occupancy(0) {update_header();}
+    inline size_t capacity() const { return tuples.size(); }
 
-    inline bool full() { return occupancy == PAGE_SIZE; }
+    inline bool full() { return occupancy == capacity(); }
+
+    // Redimensiona a página para comportar <capacity> tuplas.
+    inline void set_capacity(const size_t& capacity)
+    {
+        std::vector<T>(capacity, tuples[0]).swap(tuples);
+    }
 
     void append()
     {
@@ -115,13 +187,17 @@ private:
         update_header();
     }
 
-    bool load(const std::string& path)
+    // Adota como conteúdo uma página lida de seu slot (ver PageSystem). Conteúdo vazio indica slot vazio.
+    // <hit> indica que a página veio do cache de aplicação (modo de E/S direta), sem leitura.
+    bool load_content(std::string&& data, const bool& hit = false)
     {
-        std::ifstream file(path);
-        if (!file) return false;
-        std::stringstream().swap(content);
-        content << file.rdbuf();
-        file.close();
+        if (data.empty()) return false;
+        Instrumentation::page(hit);
+        if (!hit) Instrumentation::read(data.size());
+        content.str(std::move(data));
+        content.clear();
+        content.seekp(0, std::ios::end);
+        content.seekg(0, std::ios::beg);
         content >> occupancy;
         return true;
     }
@@ -134,6 +210,18 @@ private:
         {
             tuples.at(i) << content;
         }
+        Instrumentation::rows(occupancy);
+    }
+
+    // Decodifica apenas as colunas das posições especificadas (em ordem crescente) de cada tupla.
+    void load_tuples(const std::vector<size_t>& positions) {
+        content.clear();
+        content.seekg(21, std::ios::beg);
+        for (size_t i = 0; i < occupancy; i++)
+        {
+            tuples.at(i).load(content, positions);
+        }
+        Instrumentation::rows(occupancy);
     }
 
     void update_content()
@@ -153,17 +241,6 @@ private:
         content << std::left << std::setw(20) << occupancy << '\n';
     }
 
-    bool save(const std::string& path)
-    {
-        std::ofstream file(path);
-        if (!file) return false;
-        // std::cout << content.str() << '\n';
-        // content.flush();
-        // std::cout << content.rdbuf() << '\n';
-        file << content.str();
-        return true;
-    }
-
     inline T& operator [] (size_t i)
     {
         return tuples.at(i);
@@ -197,50 +274,184 @@ private:
 
 };
 
+// Sistema de páginas de um diretório, armazenadas em arquivos de segmento (segment.0, segment.1, ...)
+// com SEGMENT_PAGES slots de tamanho fixo cada; a página i ocupa o slot i % SEGMENT_PAGES do segmento i / SEGMENT_PAGES.
+// Cada segmento começa com uma página de cabeçalho de PAGE_SLOT_SIZE bytes; a do primeiro registra a ocupação
+// (quantidade de páginas), a capacidade (em tuplas) das páginas e o tamanho dos slots.
+// O conteúdo textual de cada página é completado com zeros até o fim do slot; um slot vazio indica página inexistente.
+// Os slots começam com PAGE_SLOT_SIZE bytes e dobram de tamanho (relocando as páginas já gravadas)
+// quando uma página não cabe; instâncias já abertas sobre o mesmo diretório não percebem a mudança.
+// No modo de E/S direta, também registrado no cabeçalho, os segmentos são abertos com O_DIRECT, as leituras
+// e escritas usam blocos alinhados (ver Frame) e as páginas lidas ou gravadas são mantidas no PageCache.
 template <typename T>
 class PageSystem
 {
 private:
-    const std::string directory, header_directory;
+    const std::string directory;
     size_t occupancy, index;
+    size_t slot_size;           // bytes por slot, múltiplo de PAGE_SLOT_SIZE
+    bool direct;                // E/S direta (O_DIRECT) com cache de aplicação
     Page<T> buffer_page;
-    std::fstream header;
+    std::vector<int> segments;  // descritores dos arquivos de segmento, abertos sob demanda (-1: ainda não aberto)
+    std::shared_ptr<ZoneMap> zone_map;  // opcional, ver track_zones
+
+    // Leitura antecipada de uma página (ver prefetch).
+    struct Prefetch
+    {
+        ReadRequest request;
+        std::string content;
+        Frame frame;        // destino alinhado da leitura, no modo direto
+        size_t uses = 0;    // carregamentos (load_page) ainda esperados da página
+        bool done = false;  // leitura concluída (ou página fora dos segmentos existentes)
+        bool hit = false;   // página obtida do cache de aplicação
+    };
+    std::map<size_t, Prefetch> prefetched;  // nós de map têm endereço estável, exigido pelas leituras em voo
+
+    // Colhe conclusões do backend da thread até que a leitura de <entry> esteja concluída.
+    void await(Prefetch& entry)
+    {
+        auto& io = AsyncIO::local();
+        while (!entry.done)
+        {
+            auto request = io.complete();
+            if (!request) break;
+            static_cast<Prefetch*>(request->tag)->done = true;
+        }
+    }
 
     friend TupleIterator;
     friend BPlusTree;
     
     template <size_t N>
     friend class Operador;
+    template <size_t N>
+    friend class SelecaoEmLote;
+    friend Juncao;
+    template <size_t N>
+    friend class Projecao;
+    friend Contagem;
+    friend Agrupamento;
+    friend Varredura;
+    friend Tabela;
 
-    inline std::string page_dir(const size_t& i)
+    inline std::string segment_path(const size_t& k) const
     {
-        return directory + std::to_string(i);
+        return directory + "segment." + std::to_string(k);
     }
 
-    inline std::string page_dir() { return page_dir(index); }
+    // Descritor do segmento <k>; com <create>, o arquivo é criado caso não exista. Retorna -1 se não puder ser aberto.
+    int segment(const size_t& k, const bool& create = false)
+    {
+        if (k >= segments.size()) segments.resize(k + 1, -1);
+        if (segments[k] < 0)
+        {
+            int flags = O_RDWR | (create? O_CREAT: 0);
+            segments[k] = direct? open_direct(segment_path(k), flags): open(segment_path(k).c_str(), flags, 0644);
+        }
+        return segments[k];
+    }
 
+    // Posição, no seu segmento, do slot da página <i> para slots de <slot> bytes.
+    static inline size_t slot_offset(const size_t& i, const size_t& slot)
+    {
+        return PAGE_SLOT_SIZE + (i % SEGMENT_PAGES)*slot;
+    }
 
-public:
-    PageSystem(const std::string& directory, size_t cur_page = 0, const std::function<T()>& newTuple = [](){return T();}):
-        directory(directory), index(cur_page), buffer_page(newTuple), header_directory(directory + "total"), header(header_directory)
+    // Interpreta o conteúdo bruto de um slot: a página termina no primeiro byte nulo.
+    static inline void trim(std::string& data, const long& read)
     {
-        if (header)
+        data.resize(read > 0? strnlen(data.data(), read): 0);
+    }
+
+    // Lê o slot <i> (de <slot> bytes) em <buffer>, que deve ser alinhado no modo direto. Retorna os bytes lidos ou -errno.
+    long read_raw(const size_t& i, const size_t& slot, char* buffer)
+    {
+        int fd = segment(i / SEGMENT_PAGES);
+        if (fd < 0) return -ENOENT;
+        return AsyncIO::read(fd, slot_offset(i, slot), buffer, slot);
+    }
+
+    // Lê o conteúdo da página <i>; <hit> indica se veio do cache de aplicação. Retorna falso se o slot está vazio.
+    bool read_slot(const size_t& i, std::string& data, bool& hit)
+    {
+        data.resize(slot_size);
+        hit = direct && PageCache::shared().get(segment_path(i / SEGMENT_PAGES), slot_offset(i, slot_size), data.data(), slot_size);
+        if (hit) trim(data, slot_size);
+        else if (!direct) trim(data, read_raw(i, slot_size, data.data()));
+        else
         {
-            std::string line;
-            std::getline(header, line);
-            std::stringstream line_stream(line);
-            line_stream >> occupancy;
-            // if (index >= occupancy)
-            // {
-            //     std::cout << "Índice de página out of bounds!\n";
-            //     index = occupancy - 1;
-            // }
+            auto frame = aligned_frame(slot_size);
+            long read = read_raw(i, slot_size, frame.get());
+            if (read > 0) std::memcpy(data.data(), frame.get(), read);
+            trim(data, read);
+            if (read == (long) slot_size) PageCache::shared().put(segment_path(i / SEGMENT_PAGES), slot_offset(i, slot_size), std::move(frame), slot_size);
+        }
+        return !data.empty();
+    }
+
+    void write_slot(const size_t& i, const std::string& data)
+    {
+        auto frame = aligned_frame(slot_size);
+        std::memset(frame.get(), 0, slot_size);
+        std::memcpy(frame.get(), data.data(), std::min(data.size(), slot_size));
+        int fd = segment(i / SEGMENT_PAGES, true);
+        for (size_t done = 0; done < slot_size; )
+        {
+            ssize_t written = pwrite(fd, frame.get() + done, slot_size - done, slot_offset(i, slot_size) + done);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) break;
+            done += written;
+        }
+        Instrumentation::write(slot_size);
+        if (direct) PageCache::shared().put(segment_path(i / SEGMENT_PAGES), slot_offset(i, slot_size), std::move(frame), slot_size);
+    }
+
+    // Dobra o tamanho dos slots até comportar <needed> bytes, movendo as páginas gravadas para suas novas posições.
+    // As páginas são movidas da última à primeira, pois nenhuma delas recua: a escrita de uma página
+    // só pode sobrepor slots antigos de páginas posteriores, já movidas.
+    void grow(const size_t& needed)
+    {
+        size_t old_slot = slot_size;
+        while (slot_size < needed) slot_size *= 2;
+        PageCache::shared().invalidate(directory);
+
+        auto frame = aligned_frame(old_slot);
+        std::string data;
+        for (size_t i = occupancy; i-- > 0; )
+        {
+            long read = read_raw(i, old_slot, frame.get());
+            data.assign(frame.get(), read > 0? read: 0);
+            trim(data, data.size());
+            if (!data.empty()) write_slot(i, data);
+        }
+        update_header();
+    }
+
+public:
+    // Abre o sistema de páginas do diretório especificado ou, caso não exista, cria-o com páginas de <capacity> tuplas,
+    // em modo de E/S direta caso <direct>. Capacidade e modo são gravados no cabeçalho, de modo que sistemas
+    // existentes sejam abertos com a capacidade e o modo com que foram criados.
+    PageSystem(const std::string& directory, size_t cur_page = 0, const std::function<T()>& newTuple = [](){return T();},
+        const size_t& capacity = PAGE_SIZE, const bool& direct = false):
+        directory(directory), index(cur_page), slot_size(PAGE_SLOT_SIZE), direct(direct), buffer_page(newTuple, capacity)
+    {
+        std::string header(PAGE_SLOT_SIZE, '\0');
+        int fd = open(segment_path(0).c_str(), O_RDONLY);
+        long read = fd < 0? 0: AsyncIO::read(fd, 0, header.data(), header.size());
+        if (fd >= 0) close(fd);
+        trim(header, read);
+        if (!header.empty())
+        {
+            std::stringstream line_stream(header);
+            size_t stored_capacity;
+            line_stream >> occupancy >> stored_capacity >> slot_size >> this->direct;
+            if (stored_capacity != capacity) buffer_page.set_capacity(stored_capacity);
             load_page();
         }
         else {
             std::filesystem::create_directories(directory);
-            header.clear();
-            header.open(header_directory, std::ios::in | std::ios::out | std::ios::trunc);
+            PageCache::shared().invalidate(directory);     // blocos de um sistema anterior no mesmo diretório
+            segment(0, true);
             occupancy = 1;
             index = 0;
             save_page();
@@ -248,10 +459,31 @@ public:
         }
     }
 
-    PageSystem(const std::string& directory, const std::function<T()>& newTuple):
-        PageSystem(directory, 0, newTuple)
+    PageSystem(const std::string& directory, const std::function<T()>& newTuple, const size_t& capacity = PAGE_SIZE, const bool& direct = false):
+        PageSystem(directory, 0, newTuple, capacity, direct)
     {}
 
+    PageSystem(PageSystem&&) = default;
+
+    // Aguarda as leituras antecipadas ainda em voo, cujos buffers pertencem a este sistema, e fecha os segmentos.
+    ~PageSystem()
+    {
+        for (auto& [page, entry]: prefetched) await(entry);
+        for (const auto& fd: segments) if (fd >= 0) close(fd);
+    }
+
+    // Fecha os descritores dos segmentos, que são reabertos sob demanda no próximo acesso.
+    // Permite manter muitos sistemas de páginas abertos (ex.: os resultados de uma seleção em lote)
+    // sem esgotar os descritores do processo. Não deve haver páginas antecipadas pendentes.
+    void release()
+    {
+        for (auto& fd: segments)
+        {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+    }
+
     PageSystem& operator << (const std::string& entry)
     {
         if (buffer_page.full())
@@ -269,10 +501,77 @@ public:
         return *this;
     }
 
+    // Carrega a página <index> no buffer; se ela foi antecipada (ver prefetch), aguarda e adota a leitura em voo.
+    // Retorna falso se a página não existe.
     bool load_page(size_t index)
     {
         this->index = index;
-        return buffer_page.load(page_dir());
+        auto entry = prefetched.find(index);
+        if (entry == prefetched.end())
+        {
+            std::string data;
+            bool hit;
+            return read_slot(index, data, hit) && buffer_page.load_content(std::move(data), hit);
+        }
+
+        auto& prefetch = entry->second;
+        await(prefetch);
+        if (prefetch.frame)
+        {
+            long read = prefetch.request.result;
+            prefetch.content.assign(prefetch.frame.get(), read > 0? read: 0);
+            if (read == (long) slot_size)
+                PageCache::shared().put(segment_path(index / SEGMENT_PAGES), slot_offset(index, slot_size), std::move(prefetch.frame), slot_size);
+            prefetch.frame.reset();
+        }
+        if (!prefetch.hit) trim(prefetch.content, prefetch.request.result);
+        bool loaded = buffer_page.load_content(prefetch.uses > 1? std::string(prefetch.content): std::move(prefetch.content), prefetch.hit);
+        if (--prefetch.uses == 0) prefetched.erase(entry);
+        return loaded;
+    }
+
+    // Inicia, pelo backend de E/S da thread (ver AsyncIO), a leitura das páginas especificadas, que serão
+    // carregadas adiante por load_page, uma vez por ocorrência na lista. Páginas repetidas (ou já antecipadas)
+    // são lidas uma única vez, e as leituras são submetidas em ordem crescente de página (e de posição no segmento).
+    // No modo direto, páginas presentes no cache de aplicação não são lidas.
+    void prefetch(const std::vector<size_t>& pages)
+    {
+        std::vector<size_t> fresh;
+        for (const auto& page: pages)
+        {
+            auto [entry, inserted] = prefetched.try_emplace(page);
+            entry->second.uses++;
+            if (inserted) fresh.push_back(page);
+        }
+        std::sort(fresh.begin(), fresh.end());
+
+        auto& io = AsyncIO::local();
+        for (const auto& page: fresh)
+        {
+            auto& entry = prefetched[page];
+            int fd = segment(page / SEGMENT_PAGES);
+            if (fd < 0)
+            {
+                entry.request.result = 0;
+                entry.done = true;
+                continue;
+            }
+            entry.content.resize(slot_size);
+            if (direct && PageCache::shared().get(segment_path(page / SEGMENT_PAGES), slot_offset(page, slot_size), entry.content.data(), slot_size))
+            {
+                trim(entry.content, slot_size);
+                entry.hit = entry.done = true;
+                continue;
+            }
+            char* buffer = entry.content.data();
+            if (direct)
+            {
+                entry.frame = aligned_frame(slot_size);
+                buffer = entry.frame.get();
+            }
+            entry.request = ReadRequest{fd, slot_offset(page, slot_size), slot_size, buffer, 0, {}, &entry};
+            io.submit(&entry.request);
+        }
     }
 
     inline bool load_page()
@@ -290,7 +589,7 @@ public:
         return load_page(occupancy - 1);
     }
 
-    void copy_to(std::fstream& out)
+    void copy_to(std::ostream& out)
     {
         do {
             auto buffer = std::move(buffer_page.content.rdbuf());
@@ -305,6 +604,11 @@ public:
         buffer_page.load_tuples();
     }
 
+    void load_tuples(const std::vector<size_t>& positions)
+    {
+        buffer_page.load_tuples(positions);
+    }
+
     // efetuar alterações após edição
     void save_tuples()
     {
@@ -314,20 +618,48 @@ public:
     void save_page()
     {
         buffer_page.update_header();
-        buffer_page.save(page_dir());
+        auto data = buffer_page.content.str();
+        if (data.size() > slot_size) grow(data.size());
+        write_slot(index, data);
+
+        if (zone_map)
+        {
+            zone_map->reset(index);
+            std::stringstream content(data);
+            std::string line;
+            content.seekg(21, std::ios::beg);
+            while (std::getline(content, line)) zone_map->update(index, line);
+        }
     }
 
+    // Passa a manter o mapa de zonas (mínimo e máximo de cada coluna) das páginas gravadas a partir de então.
+    inline void track_zones()
+    {
+        zone_map = std::make_shared<ZoneMap>();
+    }
+
+    inline std::shared_ptr<ZoneMap> get_zone_map() const { return zone_map; }
+
+    // Regrava a página de cabeçalho do primeiro segmento: ocupação, capacidade das páginas, tamanho dos slots e modo de E/S.
     void update_header()
     {
-        header.clear();
-        header.seekp(0, std::ios::beg);
-        header << std::left << std::setw(20) << occupancy << '\n';
+        std::stringstream header;
+        header << std::left << std::setw(20) << occupancy << ' ' << std::setw(20) << buffer_page.capacity()
+               << ' ' << std::setw(20) << slot_size << ' ' << direct << '\n';
+        auto line = header.str();
+        auto frame = aligned_frame(PAGE_SLOT_SIZE);
+        std::memset(frame.get(), 0, PAGE_SLOT_SIZE);
+        std::memcpy(frame.get(), line.data(), line.size());
+        pwrite(segment(0, true), frame.get(), PAGE_SLOT_SIZE, 0);
     }
 
     const Tuple& operator [] (size_t i) const { return buffer_page[i]; }
 
     inline const size_t& get_occupancy() const { return occupancy; }
 
+    // Quantidade máxima de tuplas por página.
+    inline size_t capacity() const { return buffer_page.capacity(); }
+
     // inline void clear()
     // {
     //     create_file();
@@ -343,10 +675,22 @@ private:
     TablePageSystem cur_page;
 
     friend BPlusTree;
+    friend Juncao;
+
+    std::function<bool(const size_t&)> page_filter;     // páginas rejeitadas pelo filtro não são carregadas
+    size_t skipped;
 
     bool load_page()
     {
         cur_tuple_index = 0;
+        if (page_filter)
+        {
+            while (cur_page_index < cur_page.occupancy && !page_filter(cur_page_index))
+            {
+                cur_page_index++;
+                skipped++;
+            }
+        }
         if (!cur_page.load_page(cur_page_index)) return false;
         cur_page.load_tuples();
         return true;
@@ -360,11 +704,23 @@ private:
 
 public:
     TupleIterator(const std::string& directory, const std::function<Tuple()> newTuple, size_t page = 0):
-        cur_page(directory, page, newTuple), cur_page_index(page), cur_tuple_index(0)
+        cur_page(directory, page, newTuple), cur_page_index(page), cur_tuple_index(0), skipped(0)
+    {
+        load_page();
+    }
+
+    // Iterador que percorre apenas as páginas aceitas pelo filtro especificado.
+    TupleIterator(const std::string& directory, const std::function<Tuple()> newTuple, const std::function<bool(const size_t&)>& page_filter):
+        cur_page(directory, 0, newTuple), cur_page_index(0), cur_tuple_index(0), page_filter(page_filter), skipped(0)
     {
         load_page();
     }
 
+    // Quantidade de páginas puladas pelo filtro até o momento.
+    inline size_t skipped_pages() const { return skipped; }
+
+    inline size_t page_index() const { return cur_page_index; }
+
     TupleIterator& operator ++ (int)
     {   
         if (++cur_tuple_index >= cur_page.buffer_page.occupancy)
@@ -396,27 +752,94 @@ class Tabela
 {
 private:
     std::ifstream dataset;
-    std::string directory, data_directory, result_directory;
+    std::string name, directory, data_directory, result_directory;
     Scheme scheme;
     Indices indices;
+    std::map<std::string, BloomFilter> bloom_filters;   // filtros de Bloom por página, indexados por coluna
+    std::shared_ptr<ZoneMap> zone_map;                  // mínimos e máximos de cada coluna por página
     size_t num_pages;
+    size_t fanout, page_capacity;   // escolhidos na criação da tabela
+    bool direct_io;                 // páginas de dados e nós de índices com E/S direta e cache de aplicação (ver PageCache)
     std::function<Tuple()> newTuple;
 
     friend BPlusTree;
     template <size_t N> friend class Operador;
+    template <size_t N> friend class SelecaoEmLote;
+    friend Juncao;
+    template <size_t N> friend class Projecao;
+    friend Contagem;
+    friend Agrupamento;
+    friend Varredura;
+    friend Servidor;
+
+    // Retorna o índice cuja primeira coluna é <column>, dando preferência aos de coluna única,
+    // ou nulo caso não haja nenhum. Os demais índices compostos só podem ser usados a partir de prefixos.
+    std::shared_ptr<BPlusTree> find_index(const std::string& column) const;
+
+    // Indica se a página pode conter alguma tupla que satisfaça todos os predicados de igualdade,
+    // segundo os filtros de Bloom das colunas que os possuam. Falso apenas quando certamente não contém.
+    template <typename C>
+    bool may_match(const size_t& page, const C& keys, const C& values) const
+    {
+        if (bloom_filters.empty()) return true;
+        auto value = std::begin(values);
+        for (const auto& key: keys)
+        {
+            auto filter = bloom_filters.find(key);
+            if (filter != bloom_filters.end() && !filter->second.may_contain(page, *value)) return false;
+            value++;
+        }
+        return true;
+    }
 
     // Tuple newTuple() const { return Tuple(scheme); }
     // PageSystem newPage(const size_t& index = 0) const { return PageSystem(directory, scheme, index); }
 
 public:
-    Tabela(std::string dataset_path);
+    // Cria a tabela com páginas de <page_capacity> tuplas e índices com no máximo <fanout> filhos por nó
+    // (um dos BPlusTree::supported_fanouts; caso contrário, lança invalid_argument).
+    // Com <direct_io>, páginas de dados e nós de índices são lidos e gravados com O_DIRECT, contornando o cache
+    // de páginas do sistema operacional, e mantidos no cache de aplicação (ver PageCache).
+    Tabela(std::string dataset_path, const size_t& fanout = MAX_CHILDREN, const size_t& page_capacity = PAGE_SIZE,
+        const bool& direct_io = false);
 
     void carregarDados();
 
+    // Carrega os dados criando índices apenas para as colunas especificadas, construídos em paralelo
+    // pelo escalonador compartilhado (ver Scheduler).
+    void carregarDados(const std::vector<std::string>& indexed_columns);
+
+    // Cria um índice composto sobre a lista ordenada de colunas especificada.
+    // O índice é registrado com as colunas separadas por vírgula (ex.: "ano_producao,pais_producao_id").
+    // Aceita de 1 a MAX_KEY_PARTS colunas distintas do esquema; caso contrário, lança invalid_argument.
+    // Deve ser chamado após carregarDados.
+    void criarIndice(const std::vector<std::string>& columns);
+
+    // Cria filtros de Bloom por página para as colunas especificadas (por padrão, todas), dimensionados
+    // pela capacidade das páginas da tabela e mantidos em memória. Seleções consultam esses filtros
+    // antes de carregar cada página candidata. Lança out_of_range, sem criar filtro algum, se alguma coluna
+    // não pertencer ao esquema. Deve ser chamado após carregarDados.
+    void criarFiltrosBloom(const std::vector<std::string>& columns);
+    void criarFiltrosBloom();
+
     TablePageSystem get_page(const size_t& index = 0) const;
 
     TupleIterator get_tuple_iterator() const;
 
+    // Iterador que descarta, segundo o mapa de zonas, as páginas que não podem conter
+    // tuplas cujos valores estejam em todos os intervalos especificados.
+    TupleIterator get_tuple_iterator(const std::vector<Intervalo>& ranges) const;
+
+    // Filtro de páginas do mapa de zonas: rejeita as páginas que certamente não contêm
+    // tuplas cujos valores estejam em todos os intervalos especificados.
+    std::function<bool(const size_t&)> page_filter(const std::vector<Intervalo>& ranges) const;
+
+    // Tuplas da tabela sob demanda (ver Generator), em ordem de página: cada página só é lida quando o consumidor
+    // chega a ela, e as descartadas pelo mapa de zonas segundo os intervalos especificados nunca são lidas.
+    // Os intervalos não são verificados nas tuplas. As páginas lidas e as descartadas são contabilizadas
+    // em stats.ios e stats.skipped à medida que a iteração avança; stats deve sobreviver ao gerador.
+    Generator<Tuple> tuplas(Stats& stats, std::vector<Intervalo> ranges = {}) const;
+
     TupleIterator operator [] (size_t i) const;
 
     inline BPlusTree& operator [] (const std::string& field_name) const
@@ -0,0 +1,81 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Conjunto fixo de threads trabalhadoras que consomem tarefas de uma fila compartilhada.
+// As tarefas submetidas não devem lançar exceções.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available, all_done;
+    size_t pending;     // tarefas submetidas e ainda não concluídas
+    bool stop;
+
+    void work()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex);
+                task_available.wait(lock, [this](){ return stop || !tasks.empty(); });
+                if (stop && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+
+            task();
+
+            std::unique_lock lock(mutex);
+            if (--pending == 0) all_done.notify_all();
+        }
+    }
+
+public:
+    // Por padrão, uma thread por núcleo disponível.
+    ThreadPool(size_t num_workers = std::thread::hardware_concurrency()): pending(0), stop(false)
+    {
+        if (num_workers == 0) num_workers = 1;
+        for (size_t i = 0; i < num_workers; i++) workers.emplace_back([this](){ work(); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::unique_lock lock(mutex);
+            stop = true;
+        }
+        task_available.notify_all();
+        for (auto& worker: workers) worker.join();
+    }
+
+    inline size_t size() const { return workers.size(); }
+
+    void submit(std::function<void()> task)
+    {
+        {
+            std::unique_lock lock(mutex);
+            tasks.push(std::move(task));
+            pending++;
+        }
+        task_available.notify_one();
+    }
+
+    // Bloqueia até que todas as tarefas submetidas tenham sido concluídas.
+    void wait()
+    {
+        std::unique_lock lock(mutex);
+        all_done.wait(lock, [this](){ return pending == 0; });
+    }
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,173 @@
+#ifndef VARREDURA_HPP
+#define VARREDURA_HPP
+
+#include <atomic>
+#include <mutex>
+
+#include "tabela.hpp"
+#include "csv.hpp"
+#include "stats.hpp"
+#include "scheduler.hpp"
+
+// Varredura com predicados de intervalo: SELECT * FROM tabela WHERE min_1 <= col_1 <= max_1 AND ...
+// As páginas cujas zonas (mínimo e máximo de cada coluna) não intersectam algum dos intervalos
+// são puladas sem leitura; as demais são percorridas e suas tuplas verificadas.
+// A varredura é paralela, orientada a fragmentos (morsels): o intervalo de páginas é dividido em fragmentos
+// de MORSEL_PAGES páginas, que as tarefas (executadas pelo escalonador compartilhado, ver Scheduler) reivindicam
+// dinamicamente, de modo que tarefas com fragmentos mais baratos (ex.: mais páginas descartadas) simplesmente
+// processem mais deles. Cada tarefa filtra seu fragmento
+// num buffer próprio, e os buffers são gravados no resultado na ordem das páginas, como numa varredura sequencial.
+class Varredura
+{
+private:
+    Tabela& table;
+    const std::vector<Intervalo> ranges;
+    size_t threads;
+    Stats stats;
+
+    std::string result_directory()
+    {
+        std::stringstream ss;
+        ss << table.result_directory << "scan:";
+        for (size_t i = 0; i < ranges.size(); i++)
+        {
+            if (i != 0) ss << ",";
+            ss << ranges[i].column << "=[" << ranges[i].min.value_or("") << ";" << ranges[i].max.value_or("") << "]";
+        }
+        ss << "/";
+        return ss.str();
+    }
+
+    bool matches_restriction(const Tuple& tuple)
+    {
+        for (const auto& range: ranges)
+        {
+            if (!range.contains(tuple[range.column])) return false;
+        }
+        return true;
+    }
+
+public:
+    // Até <threads> tarefas simultâneas; por padrão, uma por thread do escalonador compartilhado.
+    Varredura(Tabela& table, const std::vector<Intervalo>& ranges, const size_t& threads = Scheduler::shared().size()):
+        table(table), ranges(ranges), threads(threads), stats(0, 0, 0)
+    {}
+
+    void executar()
+    {
+        stats = Stats(0, 0, 0);
+        std::filesystem::remove_all(result_directory());
+        TablePageSystem result_page(result_directory(), table.newTuple);
+
+        size_t num_pages = table.get_page().get_occupancy();
+        size_t num_morsels = (num_pages + MORSEL_PAGES - 1) / MORSEL_PAGES;
+        auto may_match = table.page_filter(ranges);
+        std::atomic<size_t> next_morsel(0), ios(0), skipped(0);
+
+        // Tuplas (em csv) de cada fragmento concluído e ainda não gravado. Um fragmento é gravado
+        // assim que todos os anteriores o forem, pela tarefa que concluir o último deles.
+        std::vector<std::vector<std::string>> done(num_morsels);
+        std::vector<bool> ready(num_morsels, false);
+        size_t written = 0;
+        std::mutex output;
+
+        TaskGroup group;
+        for (size_t worker = 0; worker < std::min(threads, num_morsels); worker++)
+        {
+            group.run([&]()
+            {
+                TablePageSystem table_page = table.get_page();
+                std::vector<size_t> pages;
+                for (size_t morsel; (morsel = next_morsel++) < num_morsels; )
+                {
+                    pages.clear();
+                    for (size_t page = morsel*MORSEL_PAGES; page < std::min((morsel + 1)*MORSEL_PAGES, num_pages); page++)
+                    {
+                        if (may_match(page)) pages.push_back(page);
+                        else skipped++;
+                    }
+                    table_page.prefetch(pages);
+
+                    std::vector<std::string> rows;
+                    for (const auto& page: pages)
+                    {
+                        table_page.load_page(page);
+                        ios++;
+                        table_page.load_tuples();
+                        for (size_t i = 0; i < table_page.buffer_page.occupancy; i++)
+                        {
+                            if (!matches_restriction(table_page[i])) continue;
+                            std::stringstream row;
+                            row << table_page[i];
+                            rows.push_back(row.str());
+                        }
+                    }
+
+                    std::lock_guard lock(output);
+                    done[morsel] = std::move(rows);
+                    ready[morsel] = true;
+                    for (; written < num_morsels && ready[written]; written++)
+                    {
+                        for (const auto& row: done[written]) result_page << row;
+                        stats.tuples += done[written].size();
+                        std::vector<std::string>().swap(done[written]);
+                    }
+                }
+            });
+        }
+        group.wait();
+
+        stats.ios = ios;
+        stats.skipped = skipped;
+        stats.pags = result_page.occupancy;
+        result_page.update_header();
+        result_page.save_page();
+    }
+
+    // Varredura sob demanda, sequencial e sem gravar resultado: as páginas são lidas (as descartadas pelo mapa de zonas,
+    // puladas) apenas quando o consumidor chega a elas (ver Tabela::tuplas), de modo que parar a iteração cedo
+    // evite a leitura das restantes. As estatísticas são zeradas ao iniciar a iteração e acumuladas durante ela.
+    // A varredura deve sobreviver ao gerador.
+    Generator<Tuple> tuplas()
+    {
+        stats = Stats(0, 0, 0);
+        for (const auto& tuple: table.tuplas(stats, ranges))
+        {
+            if (!matches_restriction(tuple)) continue;
+            stats.tuples++;
+            co_yield tuple;
+        }
+    }
+
+    void salvarTuplasGeradas(const std::string& path)
+    {
+        std::fstream out(path, std::ios::in | std::ios::out | std::ios::trunc);
+        out << csv(table.scheme) << '\n';
+        TablePageSystem result_page(result_directory(), table.newTuple);
+        result_page.copy_to(out);
+        stats.ios += result_page.occupancy;
+    }
+
+    inline size_t numPagsGeradas()
+    {
+        return stats.pags;
+    }
+
+    inline size_t numIOExecutados()
+    {
+        return stats.ios;
+    }
+
+    inline size_t numTuplasGeradas()
+    {
+        return stats.tuples;
+    }
+
+    // Retorna a quantidade de páginas descartadas pelo mapa de zonas, sem leitura
+    inline size_t numPagsEvitadas()
+    {
+        return stats.skipped;
+    }
+};
+
+#endif // VARREDURA_HPP
@@ -0,0 +1,79 @@
+#ifndef ZONE_MAP_HPP
+#define ZONE_MAP_HPP
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <optional>
+
+#include "misc.hpp"
+
+// Predicado de intervalo fechado [min, max] sobre uma coluna; limites ausentes não restringem.
+// Igualdades são intervalos com min == max.
+struct Intervalo
+{
+    std::string column;
+    std::optional<std::string> min, max;
+
+    inline bool contains(const std::string& value) const
+    {
+        return (!min || compare_values(value, *min) >= 0) && (!max || compare_values(value, *max) <= 0);
+    }
+};
+
+// Mapa de zonas: menor e maior valor (segundo compare_values) de cada coluna em cada página de dados.
+// Permite descartar, sem leitura, páginas cujos intervalos de valores não intersectam o predicado.
+// É mantido apenas em memória e reconstruído a cada carga dos dados.
+class ZoneMap
+{
+private:
+    std::vector<std::vector<std::string>> mins, maxs;  // [página][coluna]
+
+public:
+    inline size_t num_pages() const { return mins.size(); }
+
+    // Descarta a zona da página, que será recalculada.
+    void reset(const size_t& page)
+    {
+        if (page >= num_pages())
+        {
+            mins.resize(page + 1);
+            maxs.resize(page + 1);
+        }
+        mins[page].clear();
+        maxs[page].clear();
+    }
+
+    // Incorpora à zona da página uma tupla no formato csv.
+    void update(const size_t& page, const std::string& line)
+    {
+        std::stringstream line_stream(line);
+        std::string field;
+        for (size_t column = 0; std::getline(line_stream, field, ','); column++)
+        {
+            auto& min = mins[page];
+            auto& max = maxs[page];
+            if (column >= min.size())
+            {
+                min.push_back(field);
+                max.push_back(field);
+                continue;
+            }
+            if (compare_values(field, min[column]) < 0) min[column] = field;
+            if (compare_values(field, max[column]) > 0) max[column] = field;
+        }
+    }
+
+    // Indica se alguma tupla da página pode ter, na coluna especificada, valor no intervalo [low, high].
+    // Limites ausentes não restringem o intervalo.
+    bool may_contain(const size_t& page, const size_t& column,
+        const std::optional<std::string>& low, const std::optional<std::string>& high) const
+    {
+        if (page >= num_pages() || column >= mins[page].size()) return true;
+        if (low && compare_values(maxs[page][column], *low) < 0) return false;
+        if (high && compare_values(mins[page][column], *high) > 0) return false;
+        return true;
+    }
+};
+
+#endif // ZONE_MAP_HPP
@@ -4,6 +4,8 @@
 // VOCE DEVE INCLUIR SEUS HEADERS AQUI, CASO NECESSARIO!!!
 #include "include/tabela.hpp"
 #include "include/operador.hpp"
+#include "include/juncao.hpp"
+#include "include/projecao.hpp"
 
 using namespace std;
 
@@ -14,6 +16,7 @@ int main() {
     // Tabela pais {"pais.csv"};
 
     vinho.carregarDados(); // le os dados do csv e add na estrutura da tabela, caso necessario
+    vinho.criarIndice({"ano_producao", "pais_producao_id"}); // indice composto para o filtro de dois predicados abaixo
     // uva.carregarDados();
     // pais.carregarDados();
 
@@ -26,14 +29,14 @@ int main() {
     //// significa: SELECT * FROM tabela WHERE col_1 = con_1 AND col_2 = con_2 AND ... AND col_n = con_n
 
     //// DESCOMENTE A PROXIMA LINHA CASO SEU TRABALHO SEJA PROJECAO:
-    // Operador op {vinho, new string[2] {"uva_id", "rotulo"}};
+    // Projecao op {vinho, {"uva_id", "rotulo"}};
     //// significa: SELECT uva_id, rotulo FROM Vinho
     //// IMPORTANTE: isso eh so um exemplo, pode ser outra tabela e ter mais ou menos colunas.
     //// genericamente: Operador(tabela, lista_colunas_proj):
     //// significa: SELECT col_1, col_2, ..., col_n FROM tabela
 
     //// DESCOMENTE A PROXIMA LINHA CASO SEU TRABALHO SEJA JUNCAO:
-    // Operador op {vinho, uva, "vinho_id", "uva_id"};
+    // Juncao op {vinho, uva, "uva_id", "uva_id"};
     //// significa: SELECT * FROM Vinho V, Uva U WHERE V.vinho_id = U.uva_id
     //// IMPORTANTE: isso eh so um exemplo, pode ser tabelas/colunas distintas.
     //// genericamente: Operador(tabela_1, tabela_2, col_tab_1, col_tab_2):
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/servidor.hpp"
+
+// Servidor de consultas local (ver Servidor para o protocolo).
+//
+// Uso: ./servidor [--socket CAMINHO] [--workers W] [--threads T] [--fanout F] [--page-capacity C] [--direct]
+//                 [--indice TABELA:COL1,COL2]... [--bloom] TABELA.csv...
+//   Carrega cada csv (com índices em todas as colunas, os compostos especificados e, com --bloom, filtros de Bloom)
+//   e atende requisições em CAMINHO (por padrão, generated/servidor.sock) até receber SHUTDOWN.
+//   W é a quantidade de conexões atendidas simultaneamente; T, a de threads do escalonador compartilhado
+//   pelos operadores paralelos (por padrão, ambas uma por núcleo). Exemplo:
+//   ./servidor vinho.csv uva.csv &
+//   printf 'SELECT vinho ano_producao=1996\nQUIT\n' | nc -U generated/servidor.sock
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    string socket_path = string(GEN_DIR) + "servidor.sock";
+    size_t workers = thread::hardware_concurrency(), threads = 0, fanout = MAX_CHILDREN, page_capacity = PAGE_SIZE;
+    bool direct_io = false, bloom = false;
+    vector<string> paths, composite;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) socket_path = argv[++i];
+        else if (arg == "--workers" && i + 1 < argc) workers = stoul(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) threads = stoul(argv[++i]);
+        else if (arg == "--fanout" && i + 1 < argc) fanout = stoul(argv[++i]);
+        else if (arg == "--page-capacity" && i + 1 < argc) page_capacity = stoul(argv[++i]);
+        else if (arg == "--direct") direct_io = true;
+        else if (arg == "--indice" && i + 1 < argc) composite.push_back(argv[++i]);
+        else if (arg == "--bloom") bloom = true;
+        else paths.push_back(arg);
+    }
+    if (paths.empty())
+    {
+        cerr << "uso: " << argv[0] << " [--socket CAMINHO] [--workers W] [--threads T] [--fanout F] [--page-capacity C] [--direct]"
+             << " [--indice TABELA:COL1,COL2]... [--bloom] TABELA.csv...\n";
+        return 1;
+    }
+
+    try
+    {
+        if (threads) Scheduler::configure(threads);
+        filesystem::create_directories(GEN_DIR);
+        Servidor servidor(socket_path, workers);
+        map<string, Tabela*> tables;
+        for (const auto& path: paths)
+        {
+            tables[filesystem::path(path).stem()] = &servidor.carregar(path, fanout, page_capacity, direct_io);
+        }
+        for (const auto& spec: composite)
+        {
+            auto sep = spec.find(':');
+            auto table = tables.find(spec.substr(0, sep));
+            if (sep == string::npos || table == tables.end()) throw invalid_argument("índice inválido: " + spec);
+            vector<string> columns;
+            stringstream list(spec.substr(sep + 1));
+            for (string column; getline(list, column, ','); ) columns.push_back(column);
+            table->second->criarIndice(columns);
+        }
+        if (bloom)
+        {
+            for (auto& [name, table]: tables) table->criarFiltrosBloom();
+        }
+
+        cerr << "servidor pronto em " << socket_path << " (" << workers << " conexões, "
+             << Scheduler::shared().size() << " threads)" << endl;
+        servidor.executar();
+    }
+    catch (const exception& e)
+    {
+        cerr << "erro: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,5 +1,10 @@
 #include "include/tabela.hpp"
 #include "include/b_plus_tree.hpp"
+#include "include/csv.hpp"
+#include "include/scheduler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
 
 void csv_parser(std::string entry, std::vector<std::string>& fields)
 {
@@ -13,13 +18,22 @@ bool isspace(const std::string& str)
     return str.find_first_not_of(" \t\n\v\f\r") == std::string::npos;
 }
 
-Tabela::Tabela(std::string dataset_path):
-    directory(GEN_DIR + dataset_path.substr(dataset_path.find_last_of("/\\") + 1,  dataset_path.find_last_of(".")) + "/"),
+Tabela::Tabela(std::string dataset_path, const size_t& fanout, const size_t& page_capacity, const bool& direct_io):
+    name(std::filesystem::path(dataset_path).stem()),
+    directory(GEN_DIR + name + "/"),
     data_directory(directory + "data/"),
     result_directory(directory + "results/"),
     dataset(dataset_path),
-    num_pages(0)
+    num_pages(0),
+    fanout(fanout),
+    page_capacity(page_capacity),
+    direct_io(direct_io)
 {
+    const auto& fanouts = BPlusTree::supported_fanouts();
+    if (std::find(fanouts.begin(), fanouts.end(), fanout) == fanouts.end())
+        throw std::invalid_argument("fanout não suportado: " + std::to_string(fanout));
+    if (page_capacity == 0) throw std::invalid_argument("capacidade de página nula");
+
     std::filesystem::create_directories(data_directory);
     std::filesystem::create_directories(result_directory);
     std::ofstream scheme_file(directory + "scheme")/*, pages(directory + "pages")*/;
@@ -36,9 +50,15 @@ Tabela::Tabela(std::string dataset_path):
 }
 
 void Tabela::carregarDados()
+{
+    carregarDados(scheme);
+}
+
+void Tabela::carregarDados(const std::vector<std::string>& indexed_columns)
 {
     std::string record;
-    TablePageSystem page(data_directory, newTuple);
+    TablePageSystem page(data_directory, newTuple, page_capacity, direct_io);
+    page.track_zones();
 
     while (!dataset.eof())
     {
@@ -49,13 +69,68 @@ void Tabela::carregarDados()
 
     page.update_header();
     page.save_page();
+    zone_map = page.get_zone_map();
+
+    // Os índices são independentes (cada um lê os dados com seu próprio iterador e grava seus próprios arquivos)
+    // e são construídos em paralelo, uma tarefa por coluna.
+    std::vector<std::shared_ptr<BPlusTree>> trees(indexed_columns.size());
+    TaskGroup group;
+    for (size_t i = 0; i < indexed_columns.size(); i++)
+    {
+        group.run([&, i]() { trees[i] = BPlusTree::create(*this, {indexed_columns[i]}, fanout); });
+    }
+    group.wait();
+    for (size_t i = 0; i < indexed_columns.size(); i++) indices[indexed_columns[i]] = trees[i];
+}
+
+void Tabela::criarIndice(const std::vector<std::string>& columns)
+{
+    auto tree = BPlusTree::create(*this, columns, fanout);
+    indices[csv(columns)] = tree;
+}
+
+void Tabela::criarFiltrosBloom()
+{
+    criarFiltrosBloom(scheme);
+}
+
+void Tabela::criarFiltrosBloom(const std::vector<std::string>& columns)
+{
+    TablePageSystem page = get_page();
+    std::vector<size_t> positions;
+    for (const auto& column: columns)
+    {
+        auto pos = std::find(scheme.begin(), scheme.end(), column);
+        if (pos == scheme.end()) throw std::out_of_range("coluna inexistente: " + column);
+        positions.push_back(pos - scheme.begin());
+    }
+    for (const auto& column: columns) bloom_filters.insert_or_assign(column, BloomFilter(page_capacity, page.occupancy));
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
 
-    for (auto& field_name: scheme)
+    for (size_t i = 0; i < page.occupancy; i++)
     {
-        indices[field_name] = std::make_shared<BPlusTree>(*this, field_name);
+        page.load_page(i);
+        page.load_tuples(positions);
+        for (size_t j = 0; j < page.buffer_page.occupancy; j++)
+        {
+            for (const auto& column: columns) bloom_filters[column].add(i, page[j][column]);
+        }
     }
 }
 
+std::shared_ptr<BPlusTree> Tabela::find_index(const std::string& column) const
+{
+    auto single = indices.find(column);
+    if (single != indices.end()) return single->second;
+
+    for (const auto& [name, tree]: indices)
+    {
+        if (tree->columns[0] == column) return tree;
+    }
+    return nullptr;
+}
+
 TablePageSystem Tabela::get_page(const size_t& index) const
 {
     return PageSystem(data_directory, index, newTuple);
@@ -66,6 +141,46 @@ TupleIterator Tabela::get_tuple_iterator() const
     return (*this)[0];
 }
 
+TupleIterator Tabela::get_tuple_iterator(const std::vector<Intervalo>& ranges) const
+{
+    return TupleIterator(data_directory, newTuple, page_filter(ranges));
+}
+
+std::function<bool(const size_t&)> Tabela::page_filter(const std::vector<Intervalo>& ranges) const
+{
+    std::vector<size_t> positions;
+    for (const auto& range: ranges) positions.push_back(std::find(scheme.begin(), scheme.end(), range.column) - scheme.begin());
+
+    auto zones = zone_map;
+    return [zones, ranges, positions](const size_t& page)
+    {
+        if (!zones) return true;
+        for (size_t i = 0; i < ranges.size(); i++)
+        {
+            if (!zones->may_contain(page, positions[i], ranges[i].min, ranges[i].max)) return false;
+        }
+        return true;
+    };
+}
+
+Generator<Tuple> Tabela::tuplas(Stats& stats, std::vector<Intervalo> ranges) const
+{
+    auto may_match = page_filter(ranges);
+    TablePageSystem page = get_page();
+    for (size_t i = 0; i < page.get_occupancy(); i++)
+    {
+        if (!may_match(i))
+        {
+            stats.skipped++;
+            continue;
+        }
+        page.load_page(i);
+        stats.ios++;
+        page.load_tuples();
+        for (size_t j = 0; j < page.buffer_page.occupancy; j++) co_yield page[j];
+    }
+}
+
 TupleIterator Tabela::operator [] (size_t i) const
 {
     return TupleIterator(data_directory, newTuple, i);
@@ -0,0 +1,296 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include <map>
+
+#include "include/tabela.hpp"
+#include "include/operador.hpp"
+#include "include/selecao_lote.hpp"
+#include "include/varredura.hpp"
+#include "include/juncao.hpp"
+#include "include/agregacao.hpp"
+#include "include/gerador.hpp"
+
+// Teste diferencial dos operadores.
+//
+// Uso: ./teste   (ou make check)
+//   Gera tabelas sintéticas assimétricas (vinho e uva) e, para cada fanout suportado, capacidade de página e modo de E/S,
+//   compara com uma avaliação de força bruta sobre todas as tuplas:
+//     - a seleção sequencial, a paralela por trechos de folhas, a em lote e a sob demanda (Operador::tuplas),
+//       que devem produzir as mesmas tuplas na mesma ordem (a das chaves do índice);
+//     - a varredura por intervalos paralela, com uma e com várias tarefas, na ordem das páginas;
+//     - a contagem (com índice coberto, com índice parcial e sem índice) e o agrupamento (com e sem índice);
+//     - a junção vinho.uva_id = uva.uva_id por laços aninhados indexados, por hash e por intercalação,
+//       comparada como multiconjunto de tuplas;
+//     - seleção e contagem pela primeira coluna numa tabela cujo único índice é composto, em que uma página
+//       pode ser apontada por várias chaves do prefixo (a seleção em lote é comparada como conjunto).
+//   Imprime cada divergência e termina com status 1 se houver alguma.
+
+using namespace std;
+
+static const vector<string> HEADER {"vinho_id", "rotulo", "ano_producao", "uva_id", "pais_producao_id"};
+static const vector<string> UVA_HEADER {"uva_id", "nome", "tipo", "ano_colheita", "pais_origem_id"};
+
+static size_t casos = 0, falhas = 0;
+
+static void verificar(const bool& ok, const string& descricao)
+{
+    casos++;
+    if (ok) return;
+    falhas++;
+    cerr << "FALHA: " << descricao << endl;
+}
+
+// Tuplas (em csv, sem cabeçalho) gravadas por salvarTuplasGeradas no arquivo especificado.
+static vector<string> ler(const string& path)
+{
+    ifstream in(path);
+    vector<string> rows;
+    string row;
+    getline(in, row);
+    while (getline(in, row)) rows.push_back(row);
+    return rows;
+}
+
+static vector<string> ordenadas(vector<string> rows)
+{
+    sort(rows.begin(), rows.end());
+    return rows;
+}
+
+// Tuplas da tabela que satisfazem o predicado, na ordem das páginas.
+static vector<string> forca_bruta(Tabela& table, const function<bool(TupleIterator&)>& predicate)
+{
+    vector<string> rows;
+    for (auto iter = table.get_tuple_iterator(); !iter.reached_end(); iter++)
+    {
+        if (!predicate(iter)) continue;
+        stringstream row;
+        row << *iter;
+        rows.push_back(row.str());
+    }
+    return rows;
+}
+
+// Com <lote_em_ordem> falso, a seleção em lote é comparada como conjunto: ela grava as tuplas na ordem das páginas,
+// que difere da ordem das chaves quando uma página é apontada por várias chaves do prefixo.
+template <size_t N>
+static void testar_selecao(Tabela& table, const string& config, const string (&keys)[N], const vector<array<string, N>>& queries,
+    const bool& lote_em_ordem = true)
+{
+    string path = string(GEN_DIR) + "teste/resultado.csv";
+    SelecaoEmLote<N> batch {table, keys};
+    for (const auto& query: queries) batch.adicionar(query);
+    batch.executar();
+
+    for (size_t q = 0; q < queries.size(); q++)
+    {
+        string values[N];
+        copy(queries[q].begin(), queries[q].end(), values);
+        string descricao = config + " SELECT " + csv(keys) + "=" + csv(values);
+
+        auto expected = forca_bruta(table, [&](TupleIterator& iter)
+        {
+            for (size_t i = 0; i < N; i++)
+            {
+                if (iter[keys[i]] != values[i]) return false;
+            }
+            return true;
+        });
+
+        Operador sequential {table, keys, values};
+        sequential.executar();
+        sequential.salvarTuplasGeradas(path);
+        auto rows = ler(path);
+        verificar(ordenadas(rows) == ordenadas(expected), descricao + " (sequencial x força bruta)");
+
+        Operador parallel {table, keys, values, 4};
+        parallel.executar();
+        parallel.salvarTuplasGeradas(path);
+        verificar(ler(path) == rows, descricao + " (paralela x sequencial)");
+
+        batch.salvarTuplasGeradas(q, path);
+        verificar(lote_em_ordem? ler(path) == rows: ordenadas(ler(path)) == ordenadas(rows), descricao + " (em lote x sequencial)");
+
+        vector<string> streamed;
+        for (const auto& tuple: sequential.tuplas())
+        {
+            stringstream row;
+            row << tuple;
+            streamed.push_back(row.str());
+        }
+        verificar(streamed == rows, descricao + " (sob demanda x sequencial)");
+    }
+}
+
+static void testar_varredura(Tabela& table, const string& config, const vector<Intervalo>& ranges)
+{
+    string path = string(GEN_DIR) + "teste/resultado.csv";
+    auto expected = forca_bruta(table, [&](TupleIterator& iter)
+    {
+        for (const auto& range: ranges)
+        {
+            if (!range.contains(iter[range.column])) return false;
+        }
+        return true;
+    });
+
+    for (const size_t threads: {1, 4})
+    {
+        Varredura scan {table, ranges, threads};
+        scan.executar();
+        scan.salvarTuplasGeradas(path);
+        verificar(ler(path) == expected, config + " varredura com " + to_string(threads) + " tarefas (x força bruta)");
+    }
+}
+
+template <size_t N>
+static void testar_contagem(Tabela& table, const string& config, const string (&keys)[N], const vector<array<string, N>>& queries)
+{
+    for (const auto& query: queries)
+    {
+        string values[N];
+        copy(query.begin(), query.end(), values);
+        auto expected = forca_bruta(table, [&](TupleIterator& iter)
+        {
+            for (size_t i = 0; i < N; i++)
+            {
+                if (iter[keys[i]] != values[i]) return false;
+            }
+            return true;
+        });
+
+        Contagem count {table, keys, values};
+        count.executar();
+        verificar(count.resultado() == expected.size(), config + " COUNT " + csv(keys) + "=" + csv(values) + " (x força bruta)");
+    }
+}
+
+static void testar_agrupamento(Tabela& table, const string& config, const string& column)
+{
+    string path = string(GEN_DIR) + "teste/resultado.csv";
+    map<string, size_t, ValueLess> groups;
+    for (auto iter = table.get_tuple_iterator(); !iter.reached_end(); iter++) groups[iter[column]]++;
+    vector<string> expected;
+    for (const auto& [value, count]: groups) expected.push_back(value + "," + to_string(count));
+
+    Agrupamento group {table, column};
+    group.executar();
+    group.salvarTuplasGeradas(path);
+    verificar(ler(path) == expected, config + " GROUP BY " + column + " (x força bruta)");
+}
+
+// Junção na coluna <key> de ambas as tabelas, comparada como multiconjunto de pares <externa>,<interna>.
+static void testar_juncao(Tabela& outer, Tabela& inner, const string& config, const string& key)
+{
+    string path = string(GEN_DIR) + "teste/resultado.csv";
+    map<string, vector<string>> inner_rows;
+    for (auto iter = inner.get_tuple_iterator(); !iter.reached_end(); iter++)
+    {
+        stringstream row;
+        row << *iter;
+        inner_rows[iter[key]].push_back(row.str());
+    }
+    vector<string> expected;
+    for (auto iter = outer.get_tuple_iterator(); !iter.reached_end(); iter++)
+    {
+        stringstream row;
+        row << *iter;
+        for (const auto& inner_row: inner_rows[iter[key]]) expected.push_back(row.str() + "," + inner_row);
+    }
+    expected = ordenadas(expected);
+
+    const pair<Algoritmo, string> algorithms[] {
+        {Algoritmo::LACOS_INDEXADOS, "laços aninhados indexados"}, {Algoritmo::HASH, "hash"}, {Algoritmo::MERGE, "intercalação"}};
+    for (const auto& [algorithm, name]: algorithms)
+    {
+        Juncao join {outer, inner, key, key, algorithm};
+        join.executar();
+        join.salvarTuplasGeradas(path);
+        verificar(ordenadas(ler(path)) == expected, config + " JOIN " + key + " por " + name + " (x força bruta)");
+    }
+}
+
+int main()
+{
+    Scheduler::configure(4);
+    filesystem::remove_all(GEN_DIR);
+    filesystem::create_directories(string(GEN_DIR) + "teste/");
+
+    // Chaves estrangeiras assimétricas (pais_producao_id com 5 valores, o mais frequente em cerca de 40% das tuplas)
+    // e ano_producao parcialmente correlacionado, de modo que haja prefixos que ocupam várias subárvores.
+    WineDataset dataset;
+    dataset.correlation = 0.5;
+    string csv_path = string(GEN_DIR) + "teste/vinho_teste.csv";
+    string composite_path = string(GEN_DIR) + "teste/vinho_composto.csv";
+    string uva_path = string(GEN_DIR) + "teste/uva_teste.csv";
+    {
+        ofstream out(csv_path);
+        generate_table(out, HEADER, dataset.vinho(), 3000, 7);
+        ofstream uva(uva_path);
+        generate_table(uva, UVA_HEADER, dataset.uva(), dataset.uvas, 8);
+    }
+    filesystem::copy_file(csv_path, composite_path);
+
+    vector<array<string, 1>> countries {{"0"}, {"1"}, {"2"}, {"3"}, {"4"}, {"99"}};
+    vector<array<string, 1>> years {{"1900"}, {"1950"}, {"1996"}, {"2020"}, {"1899"}};
+    vector<array<string, 2>> pairs {{"1950", "0"}, {"1996", "1"}, {"2000", "4"}, {"1900", "99"}};
+    vector<array<string, 2>> years_grapes {{"1950", "1"}, {"1996", "2"}, {"2020", "0"}, {"1899", "1"}};
+    vector<array<string, 2>> grapes_countries {{"1", "0"}, {"2", "1"}, {"7", "4"}, {"999", "0"}};
+
+    for (const auto& fanout: BPlusTree::supported_fanouts())
+    {
+        for (const size_t page_capacity: {10, 50})
+        {
+            for (const bool direct_io: {false, true})
+            {
+                string config = "[fanout " + to_string(fanout) + ", páginas de " + to_string(page_capacity)
+                    + (direct_io? ", E/S direta]": "]");
+                for (const auto& name: {"vinho_teste/", "vinho_composto/", "uva_teste/"}) filesystem::remove_all(string(GEN_DIR) + name);
+                Tabela table {csv_path, fanout, page_capacity, direct_io};
+                table.carregarDados({"ano_producao", "pais_producao_id"});
+                table.criarIndice({"pais_producao_id", "ano_producao"});
+                if (direct_io) table.criarFiltrosBloom();
+
+                testar_selecao(table, config, {"pais_producao_id"}, countries);
+                testar_selecao(table, config, {"ano_producao"}, years);
+                testar_selecao(table, config, {"ano_producao", "pais_producao_id"}, pairs);
+                testar_varredura(table, config, {{"ano_producao", string("1950"), string("1980")}});
+                testar_varredura(table, config, {{"pais_producao_id", string("1"), string("2")}, {"ano_producao", nullopt, string("1960")}});
+
+                Contagem all {table};
+                all.executar();
+                verificar(all.resultado() == forca_bruta(table, [](TupleIterator&){ return true; }).size(), config + " COUNT(*)");
+                testar_contagem(table, config, {"pais_producao_id"}, countries);
+                testar_contagem(table, config, {"ano_producao", "pais_producao_id"}, pairs);
+                testar_contagem(table, config, {"uva_id", "pais_producao_id"}, grapes_countries);
+                testar_agrupamento(table, config, "pais_producao_id");
+                testar_agrupamento(table, config, "ano_producao");
+                testar_agrupamento(table, config, "uva_id");   // sem índice
+
+                // vinho sem índice em uva_id (intercalação por ordenação externa), uva com índice na chave
+                Tabela grapes {uva_path, fanout, page_capacity, direct_io};
+                grapes.carregarDados({"uva_id"});
+                testar_juncao(table, grapes, config, "uva_id");
+
+                // único índice composto, consultado apenas pela primeira coluna
+                Tabela composite {composite_path, fanout, page_capacity, direct_io};
+                composite.carregarDados(vector<string>{});
+                composite.criarIndice({"ano_producao", "pais_producao_id"});
+                testar_selecao(composite, config + "[composto]", {"ano_producao"}, years, false);
+                testar_contagem(composite, config + "[composto]", {"ano_producao"}, years);
+                testar_contagem(composite, config + "[composto]", {"ano_producao", "uva_id"}, years_grapes);
+            }
+        }
+    }
+
+    for (const auto& name: {"teste/", "vinho_teste/", "vinho_composto/", "uva_teste/"}) filesystem::remove_all(string(GEN_DIR) + name);
+    cout << casos - falhas << "/" << casos << " casos corretos" << endl;
+    return falhas == 0? 0: 1;
+}